@@ -31,7 +31,7 @@ static uint8 encodeTab[16] = {0x16,  // 0x0 "3 out of 6" encoded
 
 // Table for decoding a 6-bit "3 out of 6" encoded data into 4-bit 
 // data. The value 0xFF indicates invalid "3 out of 6" coding
-static uint8 decodeTab[64] = {0xFF, //  "3 out of 6" encoded 0x00 decoded
+uint8 decodeTab3outof6[64] = {0xFF, //  "3 out of 6" encoded 0x00 decoded
                               0xFF, //  "3 out of 6" encoded 0x01 decoded
                               0xFF, //  "3 out of 6" encoded 0x02 decoded
                               0xFF, //  "3 out of 6" encoded 0x03 decoded
@@ -177,8 +177,8 @@ uint8 decode3outof6(uint8 *encodedData, uint8 *decodedData, uint8 lastByte)
   // - Perform decoding on the input data -
   if (!lastByte)
   {
-    data[0] = decodeTab[(*(encodedData + 2) & 0x3F)]; 
-    data[1] = decodeTab[((*(encodedData + 2) & 0xC0) >> 6) | ((*(encodedData + 1) & 0x0F) << 2)];
+    data[0] = decodeTab3outof6[(*(encodedData + 2) & 0x3F)]; 
+    data[1] = decodeTab3outof6[((*(encodedData + 2) & 0xC0) >> 6) | ((*(encodedData + 1) & 0x0F) << 2)];
   }
   // If last byte, ignore postamble sequence
   else
@@ -187,8 +187,8 @@ uint8 decode3outof6(uint8 *encodedData, uint8 *decodedData, uint8 lastByte)
     data[1] = 0x00;
   }
   
-  data[2] = decodeTab[((*(encodedData + 1) & 0xF0) >> 4) | ((*encodedData & 0x03) << 4)];
-  data[3] = decodeTab[((*encodedData & 0xFC) >> 2)];
+  data[2] = decodeTab3outof6[((*(encodedData + 1) & 0xF0) >> 4) | ((*encodedData & 0x03) << 4)];
+  data[3] = decodeTab3outof6[((*encodedData & 0xFC) >> 2)];
 
 
   // - Check for invalid data coding -
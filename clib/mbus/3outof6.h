@@ -13,6 +13,9 @@
 #define DECODING_3OUTOF6_OK      0
 #define DECODING_3OUTOF6_ERROR   1
 
+// 6 bit symbol -> 4 bit data, 0xFF for an invalid symbol
+extern uint8 decodeTab3outof6[64];
+
 
 
 //----------------------------------------------------------------------------------
@@ -5,6 +5,8 @@
 #ifndef CRC_H
 #define CRC_H
 
+#include <avr/pgmspace.h>
+
 
 //----------------------------------------------------------------------------------
 //  Constants 
@@ -12,11 +14,18 @@
 
 #define CRC_POLYNOM         0x3D65
 
+// crcCalc() inline, for the decoders
+#define CRC_STEP(crcReg, crcData) \
+  ((uint16)(((crcReg) << 8) ^ \
+   pgm_read_word(&crcTab[(uint8)(((crcReg) >> 8) ^ (crcData))])))
+
 
 //----------------------------------------------------------------------------------
 //  Function Declareration
 //----------------------------------------------------------------------------------
 
+extern const uint16 crcTab[256] PROGMEM;
+
 uint16 crcCalc(uint16 crcReg, uint8 crcData); 
 
 
@@ -29,7 +29,7 @@ static uint8 manchEncodeTab[16] = {0xAA,  // 0x0 Manchester encoded
 
 // Table for decoding 4-bit Manchester encoded data into 2-bit 
 // data. 0xFF indicates invalid Manchester encoding
-static uint8 manchDecodeTab[16] = {0xFF, //  Manchester encoded 0x0 decoded
+uint8 manchDecodeTab[16] = {0xFF, //  Manchester encoded 0x0 decoded
                                    0xFF, //  Manchester encoded 0x1 decoded
                                    0xFF, //  Manchester encoded 0x2 decoded
                                    0xFF, //  Manchester encoded 0x3 decoded
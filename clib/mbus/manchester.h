@@ -13,6 +13,9 @@
 #define MAN_DECODING_OK      0
 #define MAN_DECODING_ERROR   1
 
+// 4 bit Manchester code -> 2 bit data, 0xFF for an invalid code
+extern uint8 manchDecodeTab[16];
+
 
 //----------------------------------------------------------------------------------
 // Function declarations
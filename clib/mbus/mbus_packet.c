@@ -379,11 +379,44 @@ void encodeTXBytesTmode(uint8* pByte, uint8* pPacket, uint16 packetSize)
 }
 
 
+//----------------------------------------------------------------------------------
+//  Blocks of a Wireless MBUS packet (frame format A): the first holds 10 data
+//  bytes, the others 16, the last one may be shorter. Each ends with the 2 byte
+//  CRC of its data, high byte first.
+//
+//  The decoders below take a block at a time: decode it in one go, then run the
+//  table CRC over the bytes just written.
+//----------------------------------------------------------------------------------
+#define BLOCK_FIRST   12          // incl. CRC
+#define BLOCK_NEXT    18
+
+// Bytes in the block starting at p, CRC included
+static uint16 blockSize(uint16 size, uint8* p, uint8* end)
+{
+  return (end - p < size) ? (uint16)(end - p) : size;
+}
+
+// CRC of the n data bytes at p against the CRC field behind them
+static uint8 blockCrcOk(uint8* p, uint16 n)
+{
+  uint16 crc = 0;
+
+  while (n--)
+  {
+    crc = CRC_STEP(crc, *p);
+    p++;
+  }
+  crc = ~crc;
+  return (p[0] == HI_UINT16(crc) && p[1] == LO_UINT16(crc));
+}
+
+
+
 //----------------------------------------------------------------------------------
 //  uint16 decodeRXBytesSmode(uint8* pByte, uint8* pPacket, uint16 packetSize)
 //
 //  DESCRIPTION:
-//    Decode a SMODE packet into a Wireless MBUS packet. Checks for 3 out of 6
+//    Decode a SMODE packet into a Wireless MBUS packet. Checks for Manchester
 //    decoding errors and CRC errors.
 //
 //   ARGUMENTS:  
@@ -398,70 +431,36 @@ void encodeTXBytesTmode(uint8* pByte, uint8* pPacket, uint16 packetSize)
 //----------------------------------------------------------------------------------
 uint16 decodeRXBytesSmode(uint8* pByte, uint8* pPacket, uint16 packetSize)
 {
-  uint16 bytesRemaining;
-  uint16 bytesEncoded;
-  uint16 decodingStatus;
-  uint16 crc;             // Current CRC
-  uint16 crcField1;       // Current byte is CRC high byte
-  uint16 crcField0;       // Current byte is CRC low byte
-  
-  bytesRemaining = packetSize;
-  bytesEncoded = 0;
-  crcField1 = 0;
-  crcField0 = 0;
-  crc       = 0;
+  uint8* end = pPacket + packetSize;
+  uint8* block;
+  uint16 size = BLOCK_FIRST;
+  uint16 n;
+  uint8  d3, d2, d1, d0;
 
-  // Decode packet
-  while (bytesRemaining)
+  while (pPacket < end)
   {
-    decodingStatus = manchDecode(pByte, pPacket);
-    
-    // Check for valid Manchester decoding
-    if ( decodingStatus != MAN_DECODING_OK)
-      return (PACKET_CODING_ERROR);
-
-
-    // Check if current field is CRC field number 1, e.g.
-    // - Field 10 + 18*n
-    // - Less than 2 bytes
-    if (bytesRemaining == 2)
-      crcField1 = 1;
-
-    else if ( bytesEncoded > 9 )
-      crcField1 = !((bytesEncoded - 10) % 18);
-
-    
-    // If CRC field number 0, check the low byte of the CRC
-    if (crcField0)
-    {        
-     if (LO_UINT16(~crc) != *pPacket )
+    n = blockSize(size, pPacket, end);
+    if (n < 2)
       return (PACKET_CRC_ERROR);
+    block = pPacket;
 
-     crcField0 = 0;        
-     crc = 0;
-    }      
-
-    // If CRC field number 1, check the high byte of the CRC
-    else if (crcField1)
+    // 2 encoded bytes per byte, 2 bits per nibble, invalid ones are 0xFF
+    while (n--)
     {
-      if (HI_UINT16(~crc) != *pPacket )
-        return (PACKET_CRC_ERROR);
-     
-        // Next field is CRC field 1 
-       crcField0 = 1;
-       crcField1 = 0;
-    }
-        
-    // If not a CRC field, increment CRC calculation
-    else    
-      crc = crcCalc(crc, *pPacket);
-
+      d3 = manchDecodeTab[pByte[0] >> 4];
+      d2 = manchDecodeTab[pByte[0] & 0x0F];
+      d1 = manchDecodeTab[pByte[1] >> 4];
+      d0 = manchDecodeTab[pByte[1] & 0x0F];
+      if ((d3 | d2 | d1 | d0) & 0xFC)
+        return (PACKET_CODING_ERROR);
 
-    bytesRemaining--;
-    bytesEncoded++;      
-    pByte += 2;
-    pPacket++;
+      *pPacket++ = (d3 << 6) | (d2 << 4) | (d1 << 2) | d0;
+      pByte += 2;
+    }
 
+    if (!blockCrcOk(block, pPacket - block - 2))
+      return (PACKET_CRC_ERROR);
+    size = BLOCK_NEXT;
   }
   return (PACKET_OK);
 }
@@ -487,197 +486,109 @@ uint16 decodeRXBytesSmode(uint8* pByte, uint8* pPacket, uint16 packetSize)
 //----------------------------------------------------------------------------------
 uint16 decodeRXBytesTmode(uint8* pByte, uint8* pPacket, uint16 packetSize)
 {
-    
-  uint16 bytesRemaining;
-  uint16 bytesEncoded;
-  uint16 decodingStatus;
-  uint16 crc;               // Current CRC value
-  uint16 crcField;          // Current fields are a CRC field
+  uint8* end = pPacket + packetSize;
+  uint8* block;
+  uint16 size = BLOCK_FIRST;
+  uint16 n;
+  uint8  d3, d2, d1, d0;
 
-    
-  bytesRemaining = packetSize;
-  bytesEncoded   = 0;
-  crcField       = 0;
-  crc            = 0;
-      
-  // Decode packet      
-  while (bytesRemaining)
+  while (pPacket < end)
   {
-    // If last byte
-    if (bytesRemaining == 1)
+    n = blockSize(size, pPacket, end);
+    if (n < 2)
+      return (PACKET_CRC_ERROR);
+    block = pPacket;
+
+    // 3 encoded bytes per 2 bytes, only the last block can be odd. Invalid
+    // symbols decode to 0xFF.
+    for (; n >= 2; n -= 2)
     {
-      decodingStatus = decode3outof6(pByte, pPacket, 1);
-      
-      // Check for valid 3 out of 6 decoding
-      if ( decodingStatus != DECODING_3OUTOF6_OK)
+      d3 = decodeTab3outof6[pByte[0] >> 2];
+      d2 = decodeTab3outof6[((pByte[0] & 0x03) << 4) | (pByte[1] >> 4)];
+      d1 = decodeTab3outof6[((pByte[1] & 0x0F) << 2) | (pByte[2] >> 6)];
+      d0 = decodeTab3outof6[pByte[2] & 0x3F];
+      if ((d3 | d2 | d1 | d0) & 0xF0)
         return (PACKET_CODING_ERROR);
-      
-      bytesRemaining  -= 1;
-      bytesEncoded    += 1;
-      
-      // The last byte the low byte of the CRC field
-     if (LO_UINT16(~crc) != *(pPacket ))
-        return (PACKET_CRC_ERROR);
+
+      pPacket[0] = (d3 << 4) | d2;
+      pPacket[1] = (d1 << 4) | d0;
+      pPacket += 2;
+      pByte += 3;
     }
-         
-    else
+
+    // The last byte, the postamble after it is ignored
+    if (n)
     {
-      
-      decodingStatus = decode3outof6(pByte, pPacket, 0);
-      
-      // Check for valid 3 out of 6 decoding
-      if ( decodingStatus != DECODING_3OUTOF6_OK)
+      d3 = decodeTab3outof6[pByte[0] >> 2];
+      d2 = decodeTab3outof6[((pByte[0] & 0x03) << 4) | (pByte[1] >> 4)];
+      if ((d3 | d2) & 0xF0)
         return (PACKET_CODING_ERROR);
-        
-      bytesRemaining -= 2; 
-      bytesEncoded  += 2;
-      
-      
-      // Check if current field is CRC fields
-      // - Field 10 + 18*n
-      // - Less than 2 bytes
-      if (bytesRemaining == 0)
-        crcField = 1;
-      else if ( bytesEncoded > 10 )
-        crcField = !((bytesEncoded - 12) % 18);
-      
-      // Check CRC field
-      if (crcField)
-      {        
-       if (LO_UINT16(~crc) != *(pPacket + 1 ))
-        return (PACKET_CRC_ERROR);
-       if (HI_UINT16(~crc) != *pPacket)
-          return (PACKET_CRC_ERROR);
-       
-       crcField = 0;        
-       crc = 0;
-      }
-      
-      // If 1 bytes left, the field is the high byte of the CRC
-      else if (bytesRemaining == 1)
-      {
-        crc = crcCalc(crc, *(pPacket));
-        // The packet byte is a CRC-field
-       if (HI_UINT16(~crc) != *(pPacket + 1))
-        return (PACKET_CRC_ERROR);
-      }
 
-      // Perform CRC calculation           
-      else
-       {
-        crc = crcCalc(crc, *(pPacket));
-        crc = crcCalc(crc, *(pPacket + 1));
-       }
-   
-      pByte += 3;
-      pPacket += 2;
-      
+      *pPacket++ = (d3 << 4) | d2;
     }
+
+    if (!blockCrcOk(block, pPacket - block - 2))
+      return (PACKET_CRC_ERROR);
+    size = BLOCK_NEXT;
   }
-  
   return (PACKET_OK);
 }
 
-uint16 verifyCrcBytesCmodeA(uint8* pByte, uint8* pPacket, uint16 packetSize)
-{
-  uint16 crc = 0;
-  uint16 i = 0;
-
-  while (i < 10) {
-    crc = crcCalc(crc, pByte[i]);
-    pPacket[i] = pByte[i];
-    ++i;
-  }
-
-  if ((~crc) != (pByte[i] << 8 | pByte[i + 1])) {
-    return (PACKET_CRC_ERROR);
-  }
 
-  pPacket[i] = pByte[i];
-  ++i;
-  pPacket[i] = pByte[i];
-  ++i;
-  crc = 0;
 
-  int cycles = (packetSize - 12) / 18;
-  while (cycles > 0) {
-    for (int j = 0; j < 16; ++j) {
-      crc = crcCalc(crc, pByte[i]);
-      pPacket[i] = pByte[i];
-      ++i;
-    }
+//----------------------------------------------------------------------------------
+//  uint16 verifyCrcBytesCmodeA(uint8* pByte, uint8* pPacket, uint16 packetSize)
+//  uint16 verifyCrcBytesCmodeB(uint8* pByte, uint8* pPacket, uint16 packetSize)
+//
+//  DESCRIPTION:
+//    Copy a CMODE packet, frame format A or B, into pPacket and check the CRCs.
+//    Format B has one block of up to 126 data bytes and a second one with the
+//    rest, the L-field counts the CRC fields.
+//
+//   RETURNS:
+//    PACKET_OK              0
+//    PACKET_CRC_ERROR       2
+//----------------------------------------------------------------------------------
+static uint16 copyCrcBlocks(uint8* pByte, uint8* pPacket, uint16 packetSize,
+                            uint16 first, uint16 next)
+{
+  uint8* end = pPacket + packetSize;
+  uint16 size = first;
+  uint16 n;
+  uint16 crc;
 
-    if ((~crc) != (pByte[i] << 8 | pByte[i + 1])) {
+  while (pPacket < end)
+  {
+    n = blockSize(size, pPacket, end);
+    if (n < 2)
       return (PACKET_CRC_ERROR);
-    }
 
-    pPacket[i] = pByte[i];
-    ++i;
-    pPacket[i] = pByte[i];
-    ++i;
     crc = 0;
+    for (n -= 2; n; n--)
+    {
+      crc = CRC_STEP(crc, *pByte);
+      *pPacket++ = *pByte++;
+    }
 
-    --cycles;
-  }
-
-  if (i == packetSize) {
-    return (PACKET_OK);
-  }
-
-  while (i < packetSize - 2) {
-    crc = crcCalc(crc, pByte[i]);
-    pPacket[i] = pByte[i];
-    ++i;
-  }
-
-  if ((~crc) != (pByte[i] << 8 | pByte[i + 1])) {
-    return (PACKET_CRC_ERROR);
+    crc = ~crc;
+    if (pByte[0] != HI_UINT16(crc) || pByte[1] != LO_UINT16(crc))
+      return (PACKET_CRC_ERROR);
+    *pPacket++ = *pByte++;
+    *pPacket++ = *pByte++;
+    size = next;
   }
-
-  pPacket[i] = pByte[i];
-  ++i;
-  pPacket[i] = pByte[i];
-  ++i;
-
   return (PACKET_OK);
 }
 
-uint16 verifyCrcBytesCmodeB(uint8* pByte, uint8* pPacket, uint16 packetSize)
+uint16 verifyCrcBytesCmodeA(uint8* pByte, uint8* pPacket, uint16 packetSize)
 {
-  uint16 crc = 0;
-  uint16 i = 0;
-  if (packetSize > 128) {
-    while (i < 126) {
-      crc = crcCalc(crc, pByte[i]);
-      pPacket[i] = pByte[i];
-      ++i;
-    }
-
-    if ((~crc) != (pByte[i] << 8 | pByte[i + 1])) {
-      return (PACKET_CRC_ERROR);
-    }
-
-    pPacket[i] = pByte[i];
-    ++i;
-    pPacket[i] = pByte[i];
-    ++i;
-    crc = 0;
-  }
-
-  while (i < packetSize - 2) {
-    crc = crcCalc(crc, pByte[i]);
-    pPacket[i] = pByte[i];
-    ++i;
-  }
-
-  if ((~crc) != (pByte[packetSize - 2] << 8 | pByte[packetSize - 1])) {
-    return (PACKET_CRC_ERROR);
-  }
-
-  pPacket[packetSize - 2] = pByte[packetSize - 2];
-  pPacket[packetSize - 1] = pByte[packetSize - 1];
+  return copyCrcBlocks(pByte, pPacket, packetSize, BLOCK_FIRST, BLOCK_NEXT);
+}
 
-  return (PACKET_OK);
+uint16 verifyCrcBytesCmodeB(uint8* pByte, uint8* pPacket, uint16 packetSize)
+{
+  return copyCrcBlocks(pByte, pPacket, packetSize,
+                       (packetSize > 128) ? 128 : packetSize, packetSize);
 }
 
 /***********************************************************************************
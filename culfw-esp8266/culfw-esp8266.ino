@@ -28,10 +28,6 @@ unsigned char OCF1A;
 unsigned char OCIE1A;
 #include "board.h"
 
-byte GDO0state = 0;
-unsigned long GDO0Toggle = 0;
-byte GDO2state = 0;
-unsigned long GDO2Toggle = 0;
 unsigned long TimerMicros;
 unsigned long Timer125Hz;
 unsigned long Timer1Hz;
@@ -40,36 +36,6 @@ unsigned long Timer0Cycles = 0;
 unsigned long timer0count=0;
 unsigned long timer1count=0;
 unsigned long gdo2count=0;
-byte CheckGDO(void)
-{
-  if(GDO0state) {    //receive data
-    GDO0state = digitalRead(CC1100_OUT_PIN); 
-    // fallende Flanke: Daten vorhanden
-    if (GDO0state == 0)
-      GDO0Toggle++; 
-    //return (CheckReceiveFlag0Toggle == 0);
-  } else {             // no data
-    GDO0state = digitalRead(CC1100_OUT_PIN); 
-    if (GDO0state)
-      GDO0Toggle++; 
-    //return 0;
-  }
-  if(GDO2state)     //receive data
-  {
-    GDO2state = digitalRead(CC1100_IN_PIN); 
-    // fallende Flanke: Daten vorhanden
-    if (GDO2state == 0)
-      GDO2Toggle++; 
-    //return (CheckReceiveFlag2Toggle == 0);
-  }
-  else              // no data
-  {
-    GDO2state = digitalRead(CC1100_IN_PIN); 
-    if (GDO2state == 1)
-      GDO2Toggle++; 
-  }
-  return 0;
-}
 
 // #include <string.h>
 
@@ -95,10 +61,24 @@ byte CheckGDO(void)
 #  include "fastrf.h"
 #endif
 #include "rf_router.h"    // rf_router_func
+#ifdef HAS_RF_FRAME
+#  include "rf_frame.h"
+#endif
+#ifdef HAS_RF_LATENCY
+#  include "latency.h"
+#endif
+#include "sched.h"      // Sched
+#include "rf_pktq.h"    // RfPktq
+#ifdef HAS_PROFILE
+#  include "profile.h"
+#endif
 
 #ifdef HAS_ETHERNET
 #  include "ethernet.h"
 #endif
+#ifdef HAS_MQTT
+#  include "mqtt.h"
+#endif
 #ifdef HAS_ONEWIRE
 #  include "onewire.h"
 #endif
@@ -165,11 +145,25 @@ void spi_init() {
   SPI.setClockDivider(SPI_CLOCK_DIV2); // neu moritz
 }
 
+// All the UART has, commands are run whenever the ring is full
 void Serial_Task() {
-  if (Serial.available() > 0) {
-    uint8_t data = Serial.read();
-    TTYdata.rxBuffer.put(data);
-    Serial.write(data);
+  char buf[32];
+  int n;
+  while ((n = Serial.available()) > 0) {
+    int room = TTY_BUFSIZE - TTYdata.rxBuffer.getNbytes();
+    if (!room) {
+      TTYdata.analyze_ttydata(DISPLAY_USB);
+      continue;
+    }
+    if (n > room)
+      n = room;
+    if (n > (int)sizeof(buf))
+      n = sizeof(buf);
+    n = Serial.readBytes(buf, n);
+    if (TTYdata.echo)
+      Serial.write((const uint8_t *)buf, n);
+    for (int i = 0; i < n; i++)
+      TTYdata.rxBuffer.put(buf[i]);
   }
   //???output_flush_func = CDC_Task;
   //input_handle_func(DISPLAY_USB);
@@ -187,11 +181,65 @@ inline void ICACHE_RAM_ATTR IsrTimer0 (void){
   CLOCK.IsrHandler();
 }
 
+//////////////////////////////////////////////////////////////////////
+// Packet mode receivers: GDO2 high means a packet (AskSin, MAX!) or
+// CC1100_FIFOTHR bytes (native, wM-Bus, Z-Wave) in the FIFO, read it
+// before it overflows.
+// If the main loop is using the SPI, the task reads it instead.
+inline uint8_t ICACHE_RAM_ATTR PacketIsr(void){
+#ifdef HAS_RF_PKT_ISR
+  uint8_t ready = bit_is_set(CC1100_IN_PORT, CC1100_IN_PIN) && !CC1100.spi_busy;
+#  ifdef HAS_ASKSIN
+  if (RfAsksin.on) {
+    if (ready)
+      RfAsksin.read();
+    return 1;
+  }
+#  endif
+#  ifdef HAS_MORITZ
+  if (Moritz.is_on()) {
+    if (ready)
+      Moritz.read();
+    return 1;
+  }
+#  endif
+#  ifdef HAS_RFNATIVE
+  if (RfNative.on()) {
+    if (ready)
+      RfNative.read();
+    return 1;
+  }
+#  endif
+#  ifdef HAS_MBUS
+  if (RfMbus.on()) {
+    if (ready)
+      RfMbus.read();
+    return 1;
+  }
+#  endif
+#  ifdef HAS_ZWAVE
+  if (RfZwave.on()) {                 // both edges: GDO2 low ends a packet
+    if (!CC1100.spi_busy)
+      RfZwave.read();
+    return 1;
+  }
+#  endif
+#endif
+  return 0;
+}
+
 //////////////////////////////////////////////////////////////////////
 // "Edge-Detected" Interrupt Handler
 //ISR(CC1100_INTVECT)
 inline void ICACHE_RAM_ATTR IsrHandler (void){
   gdo2count++;
+  Sched.wake_isr(SCHED_EV_RF);
+  if (PacketIsr())
+    return;
+#ifdef HAS_RF_TX_TIMER
+  if (RfSend.tx_state == TX_RUN)      // our own transmission
+    return;
+#endif
   RfReceive.IsrHandler();
 }
 
@@ -202,7 +250,19 @@ inline void ICACHE_RAM_ATTR IsrHandler (void){
 inline void ICACHE_RAM_ATTR IsrTimer1(void)
 {
   timer1count++;
+#ifdef HAS_RF_TX_TIMER
+  if (RfSend.tx_state == TX_RUN) {    // next pulse to send
+    RfSend.IsrTimer1();
+    Sched.wake_isr(SCHED_EV_TX);
+    return;
+  }
+#endif
+#ifdef HAS_ZWAVE
+  if (RfZwave.timer())                // Z-Wave ACK or zs at its time
+    return;
+#endif
   RfReceive.IsrTimer1();
+  Sched.wake_isr(SCHED_EV_RF);
 }
 
 void loop20s(unsigned long counter) {
@@ -223,13 +283,7 @@ void loop20s(unsigned long counter) {
   Serial.print(" T1c ");
   Serial.print(timer1count); // count silence
   Serial.print(" gdo2INT ");
-  Serial.print(gdo2count);   // count gdo2 interrupts
-  Serial.print(" GDO0t ");
-  Serial.print(GDO0Toggle);
-  Serial.print(" GDO2t ");
-  Serial.println(GDO2Toggle);
-  GDO0Toggle = 0;
-  GDO2Toggle = 0;
+  Serial.println(gdo2count); // count gdo2 interrupts
   timer1count = 0;
   gdo2count = 0;
   */
@@ -250,7 +304,7 @@ const t_fntab fntab[] = {
   // 'a' CUR battery
   { 'B', [&](char *data) { FNcol.prepare_boot(data); } },
   #ifdef HAS_MBUS
-    { 'b', rf_mbus_func },
+    { 'b', [&](char *data) { RfMbus.func(data); } },
   #endif
   { 'C', [&](char *data) { CC1100.ccreg(data); } },
   #ifdef HAS_NTP
@@ -304,6 +358,12 @@ const t_fntab fntab[] = {
   #endif 
   // 'o' CUNO2 OBIS Command-Set
   // 'P' CUR picture
+  #ifdef HAS_PROFILE
+    { 'p', [&](char *data) { Profile.func(data); } },
+  #endif
+  #ifdef HAS_MQTT
+    { 'Q', [&](char *data) { Mqtt.func(data); } },
+  #endif
   #ifdef HAS_ETHERNET
     { 'q', [&](char *data) { Ethernet.close(data); } },
   #endif
@@ -337,7 +397,7 @@ const t_fntab fntab[] = {
      { 'Z', [&](char *data) { Moritz.func(data); } },
   #endif
   #ifdef HAS_ZWAVE
-    { 'z', zwave_func },
+    { 'z', [&](char *data) { RfZwave.func(data); } },
   #endif
   //doppelt, eigene Kuerzel!
   #ifdef HAS_ETHERNET
@@ -410,8 +470,12 @@ void setup() {
   led_init();
   spi_init();
 //  USB_Init();
+  TTYdata.init();
   FHT.fht_init();
   RfReceive.tx_init();
+#ifdef HAS_RF_FRAME
+  RfFrame.init();
+#endif
   //???????????????????????????????????ttydata.input_handle_func = *ttydata.analyze_ttydata;
 #ifdef HAS_RF_ROUTER
   RfRouter.init();
@@ -421,80 +485,97 @@ void setup() {
   display.channel &= ~DISPLAY_USB; //USB only when 
   Ethernet.init();
   Serial.printf("\nChannel %d \n", display.channel);
+#endif
+#ifdef HAS_MQTT
+  display.channel |= DISPLAY_MQTT;
 #endif
   Serial.print("CC1100_PARTNUM 0x00: "); Serial.println(CC1100.readStatus(0x30), HEX);
   Serial.print("CC1100_VERSION 0x14: "); Serial.println(CC1100.readStatus(0x31), HEX);
 
-  LED_OFF();
-}
-
-void loop() {
-  // put your main code here, to run repeatedly:
-#ifdef HAS_ETHERNET
-  if (!Ethernet.in_ota()){
-#endif
-  TimerMicros = micros();
-  unsigned long temp = TimerMicros/8000;
-  if (temp != Timer125Hz) {
-    Timer125Hz = temp;
-    CLOCK.IsrHandler();
-    /*/loop125Hz(Timer125Hz);
-    temp = Timer125Hz/125;
-    if (temp != Timer1Hz) {
-      Timer1Hz = temp;
-      //loop1Hz(Timer1Hz);
-      temp = Timer1Hz/20;
-      if (temp != Timer20s) {
-        Timer20s = temp;
-        loop20s(Timer20s);
-      }
-    } // 1sec loop */
-  }
-  CheckGDO();
-  
-  Serial_Task();
-  #ifndef ESP8266
-    USB_USBTask();
-    CDC_Task();
-  #endif
-  RfReceive.RfAnalyze_Task();
-  CLOCK.Minute_Task();
+  // Tasks in the order loop() called them. The receivers polling GDO2 are
+  // woken by its edges, the 125Hz tick is their fallback.
+  Sched.add(PROF_CLOCK, []() { CLOCK.IsrHandler(); Sched.wake(SCHED_EV_TICK); },
+            0, 8000);
+  Sched.add(PROF_SERIAL, Serial_Task, 0, 0);
+  Sched.add(PROF_ANALYZE, []() {
+              RfReceive.RfAnalyze_Task();
+              if(RfReceive.pending())   // one bucket per call
+                Sched.wake(SCHED_EV_RF);
+            }, SCHED_EV_RF, 0);
+  #ifdef HAS_RF_TX_TIMER
+    Sched.add(PROF_SEND, []() { RfSend.task(); }, SCHED_EV_TX|SCHED_EV_TICK, 0);
+  #endif
+  Sched.add(PROF_MINUTE, []() { CLOCK.Minute_Task(); }, SCHED_EV_TICK, 0);
+  #if defined(HAS_FHT_80b) || defined(HAS_FHT_8v)
+    Sched.add(PROF_FHT, []() { FHT.fht_task(); }, SCHED_EV_TX|SCHED_EV_TICK, 0);
+  #endif
   #ifdef HAS_FASTRF
-    FastRF.Task();
+    Sched.add(PROF_FASTRF, []() { FastRF.Task(); }, SCHED_EV_RF|SCHED_EV_TICK, 0);
   #endif
   #ifdef HAS_RF_ROUTER
-    RfRouter.task();
+    Sched.add(PROF_ROUTER, []() { RfRouter.task(); }, SCHED_EV_RF|SCHED_EV_TICK, 0);
   #endif
   #ifdef HAS_ASKSIN
-    RfAsksin.task();
+    Sched.add(PROF_ASKSIN, []() { RfAsksin.task(); }, SCHED_EV_RF|SCHED_EV_TICK, 0);
   #endif
   #ifdef HAS_IRRX
-    IR.task();
+    Sched.add(PROF_IR, []() { IR.task(); }, 0, 0);
   #endif
   #ifdef HAS_ETHERNET
-    Ethernet.Task();
+    Sched.add(PROF_ETHERNET, []() { Ethernet.Task(); }, 0, 0);
+  #endif
+  #ifdef HAS_MQTT
+    Sched.add(PROF_MQTT, []() { Mqtt.task(); }, 0, 0);
   #endif
   #ifdef HAS_MORITZ
-    Moritz.task();
+    Sched.add(PROF_MORITZ, []() {
+                Moritz.task();
+                if(RfPktq.get())        // one packet per call
+                  Sched.wake(SCHED_EV_RF);
+              }, SCHED_EV_RF|SCHED_EV_TICK, 0);
   #endif
   #ifdef HAS_RWE
-    rf_rwe_task();
+    Sched.add(PROF_RWE, rf_rwe_task, 0, 0);
   #endif
   #ifdef HAS_RFNATIVE
-    RfNative.native_task();
+    Sched.add(PROF_NATIVE, []() {
+                RfNative.native_task();
+                if(RfPktq.get())        // one packet per call
+                  Sched.wake(SCHED_EV_RF);
+              }, SCHED_EV_RF|SCHED_EV_TICK, 0);
   #endif
   #ifdef HAS_KOPP_FC
-    kopp_fc_task();
+    Sched.add(PROF_KOPP, kopp_fc_task, 0, 0);
   #endif
   #ifdef HAS_MBUS
-    rf_mbus_task();
+    Sched.add(PROF_MBUS, []() {
+                RfMbus.task();
+                if(RfMbus.pending())    // one telegram per call
+                  Sched.wake(SCHED_EV_RF);
+              }, SCHED_EV_RF|SCHED_EV_TICK, 0);
   #endif
   #ifdef HAS_ZWAVE
-    rf_zwave_task();
+    Sched.add(PROF_ZWAVE, []() {
+                RfZwave.task();
+                if(RfZwave.pending())   // one frame per call
+                  Sched.wake(SCHED_EV_RF);
+              }, SCHED_EV_RF|SCHED_EV_TICK, 0);
   #endif
   #ifdef HAS_EVOHOME
-    rf_evohome_task();
+    Sched.add(PROF_EVOHOME, rf_evohome_task, 0, 0);
   #endif
+  Sched.add(PROF_FLUSH, []() { display.flush(); }, 0, 0); // partial lines
+
+  LED_OFF();
+}
+
+void loop() {
+  // put your main code here, to run repeatedly:
+#ifdef HAS_ETHERNET
+  if (!Ethernet.in_ota()){
+#endif
+  TimerMicros = micros();
+  Sched.run();
 #ifdef HAS_ETHERNET
   } // !Ethernet.in_ota()
 #endif
@@ -46,8 +46,16 @@
 //obsolet #define HAS_FTZ
 #  define HAS_FHT_8v                    // PROGMEM:  586b  RAM: 23b
 #  define HAS_FHT_TF
-#  define FHTBUF_SIZE          174      //                 RAM: 174b
-#  define RCV_BUCKETS            4      //                 RAM: 25b * bucket
+#  define FHTBUF_DEVICES        32      // T05 for more,   heap: ~36b * n
+#  define FHTBUF_DEVSIZE        29      // bytes per FHT80b, 3 msgs of 4 cmds
+#  define RCV_BUCKETS           16      // XB for more     RAM: 28b * bucket
+#  define HAS_RF_EDGE_RING     256      // ISR only queues edges, RAM: 6b * n
+#  define HAS_RF_TX_TIMER               // RfSend queue and timer1, RAM: 1150b
+#  define HAS_RF_FRAME                  // XW: binary reports
+#  define HAS_RF_LATENCY                // XL: latency histograms, RAM: 700b
+#  define HAS_RF_PKT_ISR                // GDO2 ISR reads AskSin/MAX!/native/wM-Bus/Z-Wave packets
+#  define HAS_PROFILE                   // p: task run times, RAM: 112b per task/cmd with p1
+#  define HAS_MQTT                      // Q: MQTT client, RAM: 1.6kb
 #  define FULL_CC1100_PA                // PROGMEM:  108b
 #  define HAS_RAWSEND                   //
 //#  define HAS_ASKSIN                    // PROGMEM: 1314
@@ -70,7 +78,8 @@
 
 #if defined(CUL_V3)
 #  define TTY_BUFSIZE          128      // RAM: TTY_BUFSIZE*4
-#  undef HAS_MBUS                       // PROGMEM: 4255
+#  define HAS_MBUS                      // br: wM-Bus S/T/C RX, RAM: 1.5kb
+#  define HAS_ZWAVE                     // zr/zm: Z-Wave RX and ACK, RAM: 0.6kb
 #  if defined(HAS_MBUS)
 #    define MBUS_NO_TX                       // PROGMEM:  962
 #  endif
@@ -18,6 +18,12 @@
 #ifdef HAS_MORITZ
 #include "rf_moritz.h" // moritz_on
 #endif
+#ifdef HAS_MBUS
+#include "rf_mbus.h"   // RfMbus.off
+#endif
+#ifdef HAS_ZWAVE
+#include "rf_zwave.h"  // RfZwave.off
+#endif
 
 uint8_t cc_on;
 
@@ -151,28 +157,42 @@ const PROGMEM uint8_t FASTRF_CFG[EE_CC1100_CFG_SIZE] = {
 
 #endif
 
+// shadow_known in 32 bit words, a 64 bit shift would call libgcc (flash)
+// from the ISRs
+#define SHADOW_PA          41
+#define SHADOW_KNOWN(i)    (shadow_known[(i) >> 5] & (1UL << ((i) & 31)))
+#define SHADOW_MARK(i)     (shadow_known[(i) >> 5] |= 1UL << ((i) & 31))
+#define SHADOW_FORGET(i)   (shadow_known[(i) >> 5] &= ~(1UL << ((i) & 31)))
+
+CC1100Class::CC1100Class() {
+	shadow_reset = 1;
+}
+
 #ifdef ESP8266
-void CC1100Class::assert(void) {
+void ICACHE_RAM_ATTR CC1100Class::assert(void) {
+	spi_count++;
+	spi_busy++;
 	digitalWrite(SPI_SS,0);
 	while(digitalRead(SPI_MISO));
 }
-void CC1100Class::deassert(void) {
+void ICACHE_RAM_ATTR CC1100Class::deassert(void) {
 	while(digitalRead(SPI_MISO));
 	digitalWrite(SPI_SS,1);
+	spi_busy--;
 }
 #endif
 
-uint8_t CC1100Class::cc1100_sendbyte(uint8_t data){
+// The GDO2 and timer1 ISRs get here: SPI.transfer() is in flash, so this is
+// its register access (SPI.cpp) in IRAM
+uint8_t ICACHE_RAM_ATTR CC1100Class::cc1100_sendbyte(uint8_t data){
 #ifdef ESP8266
-  /*//SPI.cpp
 	while(SPI1CMD & SPIBUSY) {}
-	setDataBits(8);
+	SPI1U1 = (SPI1U1 & ~((SPIMMOSI << SPILMOSI) | (SPIMMISO << SPILMISO))) |
+	         (7 << SPILMOSI) | (7 << SPILMISO);  // setDataBits(8)
 	SPI1W0 = data;
 	SPI1CMD |= SPIBUSY;
 	while(SPI1CMD & SPIBUSY) {}
 	return (uint8_t) (SPI1W0 & 0xff);
-  */
-  return SPI.transfer(data);
 #else
 	SPDR = data;		        // send byte
 	while (!(SPSR & _BV (SPIF)));	// wait until transfer finished
@@ -183,8 +203,16 @@ uint8_t CC1100Class::cc1100_sendbyte(uint8_t data){
 // The manual power-up sequence
 // all internal registers and states are set to the default, IDLE state. 
 // INT mode disabled, we will pull
+// Every receiver's init gets here: the packet receivers stop using the
+// chip, the one being started sets its mode afterwards.
 
 void CC1100Class::manualReset(uint8_t first){
+#ifdef HAS_MBUS
+  RfMbus.off();
+#endif
+#ifdef HAS_ZWAVE
+  RfZwave.off();
+#endif
   #ifndef ESP8266	
 		EIMSK &= ~_BV(CC1100_INT);               //INT mode disabled
     SET_BIT( CC1100_CS_DDR, CC1100_CS_PIN ); // CS as output
@@ -194,7 +222,11 @@ void CC1100Class::manualReset(uint8_t first){
 		  pinMode(CC1100_CS_PIN, OUTPUT);
   #endif
   if (first){
+  #ifndef ESP8266
 		CC1100_DEASSERT;                           // Toggle chip select signal
+  #else
+		digitalWrite(SPI_SS,1);                    // as above, but not asserted: keep spi_busy
+  #endif
 		MYDELAY.my_delay_us(30);
 		CC1100_ASSERT;
 		MYDELAY.my_delay_us(30);
@@ -203,40 +235,64 @@ void CC1100Class::manualReset(uint8_t first){
   }
   ccStrobe( CC1100_SRES );                   // Send SRES command
   MYDELAY.my_delay_us(100);
+  shadow_known[0] = shadow_known[1] = 0;
+  shadow_reset = 0;
 }
 
 void CC1100Class::ccInitChip(uint8_t cfg){
 #ifdef HAS_MORITZ
   Moritz.on(0); //loading this configuration overwrites moritz cfg
 #endif
-  manualReset();
-  
+#ifdef HAS_MBUS
+  RfMbus.off();                   // the shadow path skips manualReset()
+#endif
+#ifdef HAS_ZWAVE
+  RfZwave.off();
+#endif
+  uint8_t buf[EE_CC1100_CFG_SIZE], pa[8];
+  for(uint8_t i = 0; i < EE_CC1100_CFG_SIZE; i++)
+    buf[i] = FNcol.erb(cfg+i);
+  for(uint8_t i = 0; i < 8; i++)
+    pa[i] = FNcol.erb(EE_CC1100_PA+i);
+
+  if(shadow_reset) {
+    load_full++;
+    manualReset();
+
 	// not in c -->
 	ccStrobe(CC1100_SFRX);
-  ccStrobe(CC1100_SFTX);
+    ccStrobe(CC1100_SFTX);
 	// not in c <--
-  
-  CC1100_ASSERT;                             // load configuration
-  cc1100_sendbyte( 0 | CC1100_WRITE_BURST );
-  for(uint8_t i = 0; i < EE_CC1100_CFG_SIZE; i++) {
-    //DH2(FNcol.erb(cfg));
-	  cc1100_sendbyte(FNcol.erb(cfg++));
-  }
-  CC1100_DEASSERT;
+
+    cc1100_writeRegs(0, buf, EE_CC1100_CFG_SIZE);   // load configuration
 	// not in c -->
-  MYDELAY.my_delay_us(10);
+    MYDELAY.my_delay_us(10);
 	// not in c <--
-
-  uint8_t pa = EE_CC1100_PA;
-
-  // setup PA table
-  CC1100_ASSERT;
-  cc1100_sendbyte( CC1100_PATABLE | CC1100_WRITE_BURST );
-  for (uint8_t i = 0;i<8;i++) {
-    //DH2(FNcol.erb(pa));
-    cc1100_sendbyte(FNcol.erb(pa++));
+    cc1100_writeRegs(CC1100_PATABLE, pa, 8);        // setup PA table
+
+  } else {
+    // The registers survive a mode switch: write only those which differ,
+    // a gap of up to 2 equal registers is written along in the same burst.
+#   define SHADOW_DIFF(i) (!SHADOW_KNOWN(i) || shadow[i] != buf[i])
+    load_diff++;
+    ccStrobe(CC1100_SIDLE);
+    ccStrobe(CC1100_SFRX);
+    ccStrobe(CC1100_SFTX);
+    for(uint8_t i = 0; i < EE_CC1100_CFG_SIZE; ) {
+      if(!SHADOW_DIFF(i)) {
+        i++;
+        continue;
+      }
+      uint8_t end = i+1;
+      for(uint8_t j = end; j < EE_CC1100_CFG_SIZE && j < end+3; j++)
+        if(SHADOW_DIFF(j))
+          end = j+1;
+      cc1100_writeRegs(i, buf+i, end-i);
+      i = end;
+    }
+    if(!SHADOW_KNOWN(SHADOW_PA) || memcmp(pa, shadow_pa, 8))
+      cc1100_writeRegs(CC1100_PATABLE, pa, 8);
   }
-  CC1100_DEASSERT;
 
   ccStrobe( CC1100_SCAL );
   MYDELAY.my_delay_ms(1);
@@ -397,6 +453,11 @@ void CC1100Class::ccreg(char *in){
     ccStrobe( CC1100_SCAL );
     ccRX();
     DH2(addr); DH2(hb); DNL();
+  } else if(in[1] == 'n') {
+    DS("spi:");   DU(spi_count, 0);
+    DS(" full:"); DU(load_full, 0);
+    DS(" diff:"); DU(load_diff, 0);
+    DNL();
   } else if(STRINGFUNC.fromhex(in+1, &hb, 1)) {
 
     if(hb == 0x99) {
@@ -422,7 +483,7 @@ void CC1100Class::ccreg(char *in){
 }
 
 //--------------------------------------------------------------------
-uint8_t CC1100Class::cc1100_readReg(uint8_t addr){
+uint8_t ICACHE_RAM_ATTR CC1100Class::cc1100_readReg(uint8_t addr){
 
   CC1100_ASSERT;
   //cc1100_sendbyte( addr|CC1100_READ_BURST );
@@ -454,16 +515,43 @@ uint8_t CC1100Class::readStatus(uint8_t addr){
 	return ret0;
 }
 
-void CC1100Class::cc1100_writeReg(uint8_t addr, uint8_t data){
+void ICACHE_RAM_ATTR CC1100Class::cc1100_writeReg(uint8_t addr, uint8_t data){
   CC1100_ASSERT;
   cc1100_sendbyte( addr|CC1100_WRITE_SINGLE );
   cc1100_sendbyte( data );
   CC1100_DEASSERT;
+  shadow_set(addr, data);
+}
+
+void CC1100Class::cc1100_writeRegs(uint8_t addr, const uint8_t *data, uint8_t n){
+  CC1100_ASSERT;
+  cc1100_sendbyte( addr|CC1100_WRITE_BURST );
+  for(uint8_t i = 0; i < n; i++)
+    cc1100_sendbyte( data[i] );
+  CC1100_DEASSERT;
+  if(addr == CC1100_PATABLE && n == 8) {
+    memcpy(shadow_pa, data, 8);
+    SHADOW_MARK(SHADOW_PA);
+  } else {
+    for(uint8_t i = 0; i < n; i++)
+      shadow_set(addr+i, data[i]);
+  }
+}
+
+void ICACHE_RAM_ATTR CC1100Class::shadow_set(uint8_t addr, uint8_t data){
+  if(addr < sizeof(shadow)) {
+    shadow[addr] = data;
+    SHADOW_MARK(addr);
+  } else if(addr == CC1100_PATABLE) {
+    SHADOW_FORGET(SHADOW_PA);
+  } else if(addr != CC1100_TXFIFO) {
+    shadow_reset = 1;               // test registers, strobes: not tracked
+  }
 }
 
 
 //--------------------------------------------------------------------
-uint8_t CC1100Class::ccStrobe(uint8_t strobe){
+uint8_t ICACHE_RAM_ATTR CC1100Class::ccStrobe(uint8_t strobe){
   CC1100_ASSERT;
   uint8_t ret = cc1100_sendbyte( strobe );
   CC1100_DEASSERT;
@@ -476,6 +564,7 @@ void CC1100Class::set_ccoff(void){
   while(cnt-- && (ccStrobe( CC1100_SIDLE ) & 0x70) != 0)
     MYDELAY.my_delay_us(10);
   ccStrobe(CC1100_SPWD);
+  SHADOW_FORGET(SHADOW_PA);        // PATABLE is lost in SLEEP
 #else
   ccStrobe(CC1100_SIDLE);
 #endif
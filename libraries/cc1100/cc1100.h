@@ -14,6 +14,7 @@
 
 class CC1100Class {
 public:
+	CC1100Class();
 	void ccInitChip(uint8_t cfg);
 	void manualReset(uint8_t first = 1);
 	void cc_factory_reset(bool);
@@ -25,6 +26,7 @@ public:
 	void ccsetpa(char*);
 	uint8_t cc1100_sendbyte(uint8_t data);
 	void cc1100_writeReg(uint8_t addr, uint8_t data);
+	void cc1100_writeRegs(uint8_t addr, const uint8_t *data, uint8_t n);
 	uint8_t cc1100_readReg(uint8_t addr);
 	uint8_t readStatus(uint8_t addr);
 	void set_ccoff(void);
@@ -33,8 +35,18 @@ public:
 	void assert(void);
 	void deassert(void);
 #endif
+	uint32_t spi_count;                 // SPI transactions
+	volatile uint8_t spi_busy;          // nesting, the GDO2 ISR must wait
 private:
     void cc_set_pa(uint8_t idx);
+	void shadow_set(uint8_t addr, uint8_t data);
+	// What was written to the chip since the last SRES, so a mode switch
+	// only has to write the registers which differ.
+	uint8_t shadow[0x29];               // config registers 00-28
+	uint8_t shadow_pa[8];
+	uint32_t shadow_known[2];           // bit n: shadow[n] valid, bit 41: PA
+	uint8_t shadow_reset;               // state unknown, ccInitChip resets
+	uint16_t load_full, load_diff;
 
 	};
 
@@ -1,4 +1,7 @@
 #include "clock.h"
+#ifdef HAS_ETHERNET
+#  include <sys/time.h>                 // gettimeofday
+#endif
 
 // count & compute in the interrupt, else long runnning tasks would block
 // a "minute" task too long
@@ -52,8 +55,8 @@ void ICACHE_RAM_ATTR CLOCKClass::IsrHandler()
 	}
 #endif
 #ifdef HAS_FHT_80b
-  if(FHT.fht80b_timeout != FHT_TIMER_DISABLED)
-    FHT.fht80b_timeout--;
+  if(FHT.fht80b_timeout != FHT_TIMER_DISABLED && !FHT.fht80b_tx)
+    FHT.fht80b_timeout--;               // counts from the answer on
 #endif
 }
 
@@ -65,6 +68,21 @@ void CLOCKClass::get_timestamp(uint32_t *ts)
   //SREG = l;
 }
 
+// A micros() value of the last 71 minutes as epoch microseconds, or as
+// microseconds since boot while SNTP has not set the time yet.
+uint64_t CLOCKClass::stamp_us(uint32_t us)
+{
+  uint64_t now = micros64();
+  uint64_t t = now - (uint32_t)((uint32_t)now - us);
+#ifdef HAS_ETHERNET
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  if(tv.tv_sec > 1500000000)           // set by SNTP, see Ethernet.init
+    t += (uint64_t)tv.tv_sec*1000000 + tv.tv_usec - now;
+#endif
+  return t;
+}
+
 void CLOCKClass::gettime(char *unused)
 {
   uint32_t actticks;
@@ -55,6 +55,7 @@ public:
 	void gettime(char*);
 	//public?
 	void get_timestamp(uint32_t *ts);
+	uint64_t stamp_us(uint32_t us);
 	void IsrHandler();
 	void Minute_Task(void);
 
@@ -3,6 +3,7 @@
 
 #include "ringbuffer.h"
 #include "rf_router.h"
+#include "ttydata.h"              // si
 #ifndef ESP8266
 	#ifdef HAS_USB
 	//#include "cdc.h"
@@ -24,6 +25,9 @@
 #ifdef HAS_ETHERNET
   #include "ethernet.h"
 #endif
+#ifdef HAS_MQTT
+  #include "mqtt.h"
+#endif
 #ifdef HAS_DOGM
   #include "dogm16x.h"
 #endif
@@ -38,11 +42,46 @@ DisplayClass::DisplayClass() {
 	log_enabled = 0;
 	channel = 0;
 	echo_serial = true;
+	line_len = 0;
 }
 
 //////////////////////////////////////////////////
 // Display routines
 void DisplayClass::chr(char data)
+{
+  line[line_len++] = data;
+  if(data == '\n' || line_len == sizeof(line))
+    flush();
+}
+
+// Hand the collected line to the sinks: one write for serial, TCP and MQTT,
+// the character based sinks get it byte by byte.
+void DisplayClass::flush(void)
+{
+  uint8_t n = line_len;
+  if(!n)
+    return;
+  line_len = 0;
+
+#ifdef HAS_ETHERNET
+  if(channel & DISPLAY_TCP)
+    Ethernet.write(line, n);
+#endif
+#ifdef HAS_MQTT
+  if(channel & DISPLAY_MQTT)
+    Mqtt.line(line, n);
+#endif
+
+#if defined(HAS_USB) && defined(ESP8266)
+  if(USB_IsConnected && ((channel & DISPLAY_USB) || echo_serial))
+    Serial.write((const uint8_t *)line, n);
+#endif
+
+  for(uint8_t i = 0; i < n; i++)
+    sink_chr(line[i]);
+}
+
+void DisplayClass::sink_chr(char data)
 {
 #ifdef RFR_SHADOW
   uint8_t buffer_free = 1;
@@ -63,11 +102,6 @@ void DisplayClass::chr(char data)
 #endif
 */
 
-#ifdef HAS_ETHERNET
-  if(channel & DISPLAY_TCP)
-    Ethernet.putChar( data );
-#endif
-
 #ifdef HAS_PRIVATE_CHANNEL
     private_putchar( data );
 #endif
@@ -77,18 +111,14 @@ void DisplayClass::chr(char data)
     dogm_putchar( data );
 #endif
 
-#ifdef HAS_USB
+#if defined(HAS_USB) && !defined(ESP8266)
   if(USB_IsConnected && ((channel & DISPLAY_USB) || echo_serial)) {
-		#ifndef ESP8266
-		  if(TTY_Tx_Buffer.nbytes >= TTY_BUFSIZE)
-				CDC_Task();
-			TTY_Tx_Buffer.put(data);
-			if(data == '\n')
-				CDC_Task();
-			buffer_used();
-		#else
-			Serial.print(data);
-		#endif
+	  if(TTY_Tx_Buffer.nbytes >= TTY_BUFSIZE)
+			CDC_Task();
+		TTY_Tx_Buffer.put(data);
+		if(data == '\n')
+			CDC_Task();
+		buffer_used();
   }
 #endif
 
@@ -178,7 +208,10 @@ void DisplayClass::string(char *s)
 }
 
 void DisplayClass::string_P(const __FlashStringHelper *s) {
-	Serial.print(s);
+  PGM_P p = reinterpret_cast<PGM_P>(s);
+  char c;
+  while((c = pgm_read_byte(p++)))
+    chr(c);
 }
 
 void DisplayClass::string_P(const char *s)
@@ -200,10 +233,10 @@ void DisplayClass::nL()
   chr('\n');
 }
 
-void DisplayClass::udec(uint16_t d, int8_t pad, uint8_t padc)
+void DisplayClass::udec(uint32_t d, int8_t pad, uint8_t padc)
 {
-  char buf[6];
-  uint8_t i=6;
+  char buf[11];
+  uint8_t i=11;
 
   buf[--i] = 0;
   do {
@@ -240,8 +273,25 @@ void DisplayClass::hex2(uint8_t h)
   hex(h, 2, '0');
 }
 
+// n bytes as hex, two digits each, written directly into the line
+void DisplayClass::hexbuf(const uint8_t *d, uint8_t n)
+{
+  static const char digits[] = "0123456789ABCDEF";
+
+  while(n--) {
+    if(line_len > sizeof(line)-2)
+      flush();
+    line[line_len++] = digits[*d >> 4];
+    line[line_len++] = digits[*d++ & 0xf];
+  }
+}
+
 void DisplayClass::func(char *in)
 {
+  if(in[1] == 'i') {                // echo of the USB input
+    TTYdata.echo_func(in);
+    return;
+  }
   if(in[1] == 'd') {                // no echo on USB
     echo_serial = false;
   } else if(in[1] == 'e') {         // echo on USB
@@ -52,6 +52,11 @@
 #define DISPLAY_TCP      (1<<2)
 #define DISPLAY_RFROUTER (1<<3)
 #define DISPLAY_DOGM     (1<<4)
+#define DISPLAY_MQTT     (1<<5)
+
+#ifndef DISPLAY_BUFSIZE
+#  define DISPLAY_BUFSIZE 128          // one line, RAM: 1b * n
+#endif
 
 class DisplayClass {
 public:
@@ -60,14 +65,21 @@ public:
 	void string(char *s);
 	void string_P(const __FlashStringHelper *s);
 	void string_P(const char *s);
-	void udec(uint16_t d, int8_t pad, uint8_t padc);
+	void udec(uint32_t d, int8_t pad, uint8_t padc);
 	void hex(uint16_t h, int8_t pad, uint8_t padc);
 	void hex2(uint8_t h);
+	void hexbuf(const uint8_t *d, uint8_t n);
 	void nL(void);
+	void flush(void);
   void func(char *in);
 	uint8_t channel;
 	uint8_t log_enabled;
 	uint8_t echo_serial;
+private:
+	// Output is collected up to the end of the line, each sink gets it once
+	char line[DISPLAY_BUFSIZE];
+	uint8_t line_len;
+	void sink_chr(char data);
 };
 
 #if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_DISPLAY)
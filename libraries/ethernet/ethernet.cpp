@@ -8,6 +8,9 @@
 #include "stringfunc.h"
 #include "display.h"
 #include "ttydata.h"
+#ifdef HAS_RF_LATENCY
+#  include "latency.h"
+#endif
 #ifndef ESP8266
 #  include "delay.h"
 #  include "timer.h"
@@ -27,9 +30,9 @@ uint8_t eth_debug = 0;
 static uint8_t dhcp_state;
 
 EthernetClass::EthernetClass() {
-	ReplyPos = 0;
 #ifdef ESP8266
 	now_in_ota = 0;
+	ip_active = -1;
 #endif
 }
 
@@ -128,6 +131,14 @@ void EthernetClass::init(void)
 		uip_hostaddr[0] = localIP[1]<<8 | localIP[0];
 		uip_hostaddr[1] = localIP[3]<<8 | localIP[2];
 		WiFi.macAddress(uip_ethaddr.addr);
+		// SNTP keeps the system time, CLOCK.stamp_us converts with it
+		static char ntp_server[16];
+		IPAddress ntp(FNcol.erb(EE_IP4_NTPSERVER),   FNcol.erb(EE_IP4_NTPSERVER+1),
+		              FNcol.erb(EE_IP4_NTPSERVER+2), FNcol.erb(EE_IP4_NTPSERVER+3));
+		if(!ntp[0])
+			ntp = WiFi.gatewayIP();
+		strncpy(ntp_server, ntp.toString().c_str(), sizeof(ntp_server)-1);
+		configTime(0, 0, ntp_server);
 		Serial.printf("\nUDP %d, TCP %d on %s:%d\n", eth_initialized, tcp_initialized, WiFi.localIP().toString().c_str(), tcplink_port);
   } else {
 		Serial.println('\nNo WLan');
@@ -158,6 +169,8 @@ void EthernetClass::reset(bool commit = true)
     buf[2] = 'k'; strcpy_P(buf+3, PSTR("password"));      FNcol.write_eeprom(buf, false);//WPA_KEY;
     buf[2] = 'D'; strcpy_P(buf+3, PSTR("cul-esp"));       FNcol.write_eeprom(buf, false);//EE_NAME;
     buf[2] = 'O'; strcpy_P(buf+3, PSTR("0.0.0.0"));       FNcol.write_eeprom(buf, false);//OTA_SERVER;
+    buf[2] = 'u'; strcpy_P(buf+3, PSTR("0.0.0.0"));       FNcol.write_eeprom(buf, false);//UDP reports off
+    buf[2] = 'U'; strcpy_P(buf+3, PSTR("2323"));          FNcol.write_eeprom(buf, false);
 # endif
 
 #ifdef EE_DUDETTE_MAC
@@ -197,32 +210,211 @@ void EthernetClass::reset(bool commit = true)
   FNcol.write_eeprom(buf, commit);
 }
 
-// 1 char senden
-//__attribute__((__noinline__))
-void EthernetClass::putChar(char data)
+// A line from DisplayClass. The reply to a command goes to the client
+// which sent it, everything else (RF reports) to every client and the
+// UDP destination.
+void EthernetClass::write(const char *buf, uint8_t len)
 {
-	ReplyBuffer[ReplyPos++] = data;
-	ReplyBuffer[ReplyPos] = 0;
-	if (data == 0 || data == '\n' /*|| data == '\r'*/ || ReplyPos >= 80) {
-		// send a reply, to the IP address and port that sent us the packet we received
-		if (ip_active == TCP_MAX){
+	if (ip_active == TCP_MAX) {               // reply to a UDP command
+		if (!udp_reply)
 			Udp.beginPacket(Udp.remoteIP(), Udp.remotePort());
-			IPAddress ip(192, 168, 178, 59);
-			//Serial.print("put2 ");
-			if (Udp.beginPacket(ip, 2323)) {
-			int n = Udp.write(ReplyBuffer);
-			//Serial.print(n);
-			n = Udp.endPacket();
-			//Serial.println(n);
-			}
+		udp_reply += Udp.write((const uint8_t *)buf, len);
+		return;
+	}
+	if (ip_active >= 0 && ip_active < tcp_initialized) {
+		queue_put(ip_active, buf, len);
+		return;
+	}
+	for (uint8_t i = 0; i < tcp_initialized; i++)
+		queue_put(i, buf, len);
+	udp_put(buf, len);
+}
+
+// Wiu0.0.0.0 switches the reports off, so does an erased EEPROM (255.x)
+// left by an upgrade from a version without Wiu.
+uint8_t EthernetClass::udp_on(void)
+{
+	uint8_t a = FNcol.erb(EE_UDP_ADDR);
+	return a && a != 0xff;
+}
+
+// Collect report lines, a datagram is sent when the next line does not
+// fit or the oldest line is UDP_FLUSH_MS old.
+void EthernetClass::udp_put(const char *buf, uint8_t len)
+{
+	if (!eth_initialized || !udp_on())
+		return;
+	if (udp_len + len > UDP_MTU)
+		udp_flush();
+	if (!udp_len) {
+		udp_len = sprintf(udp_buf, "#%04X\n", udp_seq);
+		udp_since = millis();
+	}
+	memcpy(udp_buf + udp_len, buf, len);
+	udp_len += len;
+}
+
+// The sequence number counts failed datagrams too, the receiver sees
+// every loss as a gap.
+void EthernetClass::udp_flush(void)
+{
+	if (!udp_len)
+		return;
+	IPAddress ip(FNcol.erb(EE_UDP_ADDR),   FNcol.erb(EE_UDP_ADDR+1),
+	             FNcol.erb(EE_UDP_ADDR+2), FNcol.erb(EE_UDP_ADDR+3));
+	uint16_t port = FNcol.erw(EE_UDP_PORT);
+	int ok = (ip[0] & 0xf0) == 0xe0 ?         // 224.0.0.0/4
+	         Udp.beginPacketMulticast(ip, port, WiFi.localIP()) :
+	         Udp.beginPacket(ip, port);
+	if (ok) {
+		Udp.write((const uint8_t *)udp_buf, udp_len);
+		if (Udp.endPacket())
+			udp_sent++;
+	}
+	udp_seq++;
+	udp_len = 0;
+}
+
+// A datagram is a command line (or several), the reply is one datagram
+// back to the sender.
+void EthernetClass::udp_input(void)
+{
+	char buf[TCP_RX_BUDGET];
+	int n, last = '\n';
+
+	ip_active = TCP_MAX;
+	udp_reply = 0;
+	while ((n = Udp.read(buf, sizeof(buf))) > 0) {
+		if (eth_debug)
+			Serial.write((const uint8_t *)buf, n);
+		TTYdata.analyze_line(&UdpLine, buf, n, DISPLAY_TCP);
+		last = buf[n-1];
+	}
+	if (last != '\n' && last != '\r')     // the datagram ends the line
+		TTYdata.analyze_line(&UdpLine, "\n", 1, DISPLAY_TCP);
+	display.flush();
+	if (udp_reply)
+		Udp.endPacket();
+	ip_active = -1;
+}
+
+// Queue for client i. If it is full the oldest messages are dropped, a
+// client which does not read for TCP_DROP_MAX messages is closed.
+void EthernetClass::queue_put(uint8_t i, const char *buf, uint8_t len)
+{
+	tcp_queue_t *q = &TcpQ[i];
+
+	if (!len)
+		return;
+	while (TCP_QUEUE - q->len < len || q->units == TCP_UNITS) {
+		if (!queue_drop(q) || ++q->drops >= TCP_DROP_MAX) {
+			Serial.printf("\nTCP %d too slow, closed\n", i);
+			Tcp[i].stop();
+			q->head = q->len = q->uhead = q->units = q->sent = 0;
+			return;
 		}
-		if (ip_active >= 0 && ip_active < tcp_initialized) 
-		{
-			int n = Tcp[ip_active].print(ReplyBuffer);
+		q->dropped++;
+	}
+
+#ifdef HAS_RF_LATENCY
+	if (!q->len)
+		q->since = micros();
+#endif
+	uint16_t in = (q->head + q->len) % TCP_QUEUE;
+	uint16_t n = TCP_QUEUE - in;
+	if (n > len)
+		n = len;
+	memcpy(q->buf + in, buf, n);
+	memcpy(q->buf, buf + n, len - n);
+	q->len += len;
+	q->unit[(q->uhead + q->units++) & (TCP_UNITS-1)] = len;
+}
+
+// Remove the oldest message. A partly sent one at the head stays, the
+// message after it is removed instead.
+uint8_t EthernetClass::queue_drop(tcp_queue_t *q)
+{
+	uint16_t keep = 0;
+	uint8_t u = q->uhead;
+
+	if (q->sent) {
+		if (q->units < 2)
+			return 0;
+		keep = q->unit[u] - q->sent;         // its rest, still queued
+		u = (u + 1) & (TCP_UNITS-1);
+	} else if (!q->units)
+		return 0;
+
+	uint16_t n = q->unit[u];                  // length of the dropped one
+	while (keep--)
+		q->buf[(q->head + keep + n) % TCP_QUEUE] =
+			q->buf[(q->head + keep) % TCP_QUEUE];
+	q->head = (q->head + n) % TCP_QUEUE;
+	q->len -= n;
+	if (q->sent)                              // the kept one moves up
+		q->unit[u] = q->unit[q->uhead];
+	q->uhead = (q->uhead + 1) & (TCP_UNITS-1);
+	q->units--;
+	return 1;
+}
+
+// Send as much as the client takes without blocking
+void EthernetClass::queue_send(uint8_t i)
+{
+	tcp_queue_t *q = &TcpQ[i];
+	size_t room = Tcp[i].availableForWrite();
+
+	while (q->len && room) {
+		size_t n = TCP_QUEUE - q->head;
+		if (n > q->len)
+			n = q->len;
+		if (n > room)
+			n = room;
+		n = Tcp[i].write((const uint8_t *)q->buf + q->head, n);
+		if (!n)
+			break;
+		q->head = (q->head + n) % TCP_QUEUE;
+		q->len -= n;
+		q->drops = 0;
+		room -= n;
+		n += q->sent;                         // complete messages are gone
+		while (q->units && n >= q->unit[q->uhead]) {
+			n -= q->unit[q->uhead];
+			q->uhead = (q->uhead + 1) & (TCP_UNITS-1);
+			q->units--;
 		}
-		//Serial.printf("\nsend to client %d %s:%d\n", ip_active, Tcp[ip_active].remoteIP().toString().c_str(), Tcp[ip_active].remotePort());
+		q->sent = n;
+	}
+#ifdef HAS_RF_LATENCY
+	if (!q->len && q->since) {
+		Latency.add(LAT_TCP, micros() - q->since);
+		q->since = 0;
+	}
+#endif
+}
 
-		ReplyPos = 0;
+void EthernetClass::queue_show(void)
+{
+	for (uint8_t i = 0; i < tcp_initialized; i++) {
+		DU(i,1); DC(' ');
+		IPAddress ip = Tcp[i].remoteIP();
+		display_ip4((uint8_t *)&ip[0]);
+		DC(':'); DU(Tcp[i].remotePort(),0);
+		DS(" queued:");  DU(TcpQ[i].len,0);
+		DS(" dropped:"); DU(TcpQ[i].dropped,0);
+		DNL();
+	}
+	if (udp_on()) {
+		uint8_t ip[4];
+		for (uint8_t k = 0; k < 4; k++)
+			ip[k] = FNcol.erb(EE_UDP_ADDR+k);
+		DS("udp ");
+		display_ip4(ip);
+		DC(':'); DU(FNcol.erw(EE_UDP_PORT),0);
+		DS(" seq:");    DU(udp_seq,0);
+		DS(" sent:");   DU(udp_sent,0);
+		DS(" queued:"); DU(udp_len,0);
+		DNL();
 	}
 }
 
@@ -260,6 +452,7 @@ void EthernetClass::ota(){
 		t_httpUpdate_return ret = httpUpdate.update(wifiClient, para.mqtt_server, 80, "/esp8266/ota.php", tochararray(cstr, mVersionNr, mVersionBoard));
 # else      
 		DS("[update] start ");
+		display.flush();
 		t_httpUpdate_return ret = ESPhttpUpdate.update(host, 80, "/esp8266/ota.php", con_cat(VERSION_OTA, VERSION_BOARD));
 # endif
 	switch (ret) {
@@ -296,6 +489,10 @@ void EthernetClass::func(char *in)
     display_ip4((uint8_t *)uip_hostaddr); DC(':');DU(tcplink_port,0);DC(' ');
     display_mac((uint8_t *)uip_ethaddr.addr);
     DNL();
+#ifdef ESP8266
+  } else if(in[1] == 'q') {
+    queue_show();
+#endif
   } else if(in[1] == 'd') {
     eth_debug = (eth_debug+1) & 0x3;
     DH2(eth_debug);
@@ -365,26 +562,17 @@ void EthernetClass::Task(void) {
 	  
      }
 #else
-  // if there's udp-data available, read a packet
-  int packetSize = Udp.parsePacket();
-  //Serial.print(packetSize);
-  if (packetSize) {
-    /*Serial.printf("Received packet of size %d from %s:%d\n    (to %s:%d, free heap = %d B)\n",
-                  packetSize,
-                  Udp.remoteIP().toString().c_str(), Udp.remotePort(),
-                  Udp.destinationIP().toString().c_str(), Udp.localPort(),
-                  ESP.getFreeHeap());*/
-
-    // read the packet into packetBufffer
-    int n = Udp.read(packetBuffer, UDP_TX_PACKET_MAX_SIZE);
-    packetBuffer[n] = 0;
-    //Serial.printf("UDP: %s\n", packetBuffer);
-    //ip_active = TCP_MAX;
-  }
+  // udp-data: commands
+  if (Udp.parsePacket())
+    udp_input();
+  if (udp_len && millis() - udp_since >= UDP_FLUSH_MS)
+    udp_flush();
   // tcp-data
   if (tcp_initialized < TCP_MAX){
 	  Tcp[tcp_initialized] = server.available();
 	  if (Tcp[tcp_initialized]) {
+		  memset(&TcpQ[tcp_initialized], 0, sizeof(tcp_queue_t));
+		  TcpLine[tcp_initialized].len = TcpLine[tcp_initialized].toolong = 0;
       Serial.printf("\nUDP %d, TCP %d to %s:%d\n", eth_initialized, tcp_initialized, Tcp[tcp_initialized].remoteIP().toString().c_str(), Tcp[tcp_initialized].remotePort());
 		  tcp_initialized++;
 	  }
@@ -395,22 +583,23 @@ void EthernetClass::Task(void) {
     // we have a client sending some request
 		if (Tcp[i].connected())
 		{
-			while (Tcp[i].available())
-			{
-				//int n = Tcp.read(packetBuffer, UDP_TX_PACKET_MAX_SIZE);
-				//String line = Tcp.readStringUntil('\r');
-				char line = Tcp[i].read();
-				if(line > 0){
-					Serial.print(line);
-					TTYdata.rxBuffer.put(line);
-				}
+			// at most TCP_RX_BUDGET bytes, the rest waits for the next round
+			char buf[TCP_RX_BUDGET];
+			int n = Tcp[i].read((uint8_t *)buf, sizeof(buf));
+			if (n > 0) {
+				if (eth_debug)
+					Serial.write((const uint8_t *)buf, n);
+				ip_active = i;               // replies to this client only
+				TTYdata.analyze_line(&TcpLine[i], buf, n, DISPLAY_TCP);
+				display.flush();
+				ip_active = -1;
 			}
-			ip_active = i;
-			//TTYdata.analyze_ttydata(DISPLAY_USB|DISPLAY_TCP);
-			TTYdata.analyze_ttydata(DISPLAY_TCP);
+			queue_send(i);
 		} else {
 			for(uint8_t k=i; k<TCP_MAX-1; k++){
 				Tcp[k] = Tcp[k+1];
+				TcpQ[k] = TcpQ[k+1];
+				TcpLine[k] = TcpLine[k+1];
 			}
 			tcp_initialized--;
 			if (i == ip_active)
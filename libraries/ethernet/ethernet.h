@@ -2,11 +2,22 @@
 #define __ETHERNET_H_
 
 #include "board.h"
+#include "ttydata.h"
 
 #ifdef ESP8266
 #   include <WiFiUdp.h>
 #   include <ESP8266WiFi.h>
 #   define TCP_MAX 5
+#   ifndef TCP_QUEUE
+#     define TCP_QUEUE    512          // output per client, RAM: TCP_MAX * n
+#   endif
+#   define TCP_UNITS     64           // messages per client, power of 2, RAM: TCP_MAX * n
+#   define TCP_DROP_MAX  32           // messages dropped without progress: close
+#   define TCP_RX_BUDGET 64           // input bytes per client and Task()
+#   ifndef UDP_MTU
+#     define UDP_MTU      1400         // payload of one report datagram
+#   endif
+#   define UDP_FLUSH_MS  50           // a report line waits at most this long
 	// von http://marcotuliogm.github.io/mult-UIP/docs/html/group__uip.html
 	typedef struct uip_eth_addr {
 		uint8_t addr[6];
@@ -19,6 +30,21 @@
     public:
       WiFiServerExt():WiFiServer(0){}
 	};
+	// Output not yet accepted by a TCP client, a ring of whole messages:
+	// a message is what display flushes in one write(), a line or an XW01
+	// frame, which may contain '\n' or end without it
+	typedef struct {
+		char buf[TCP_QUEUE];
+		uint16_t head, len;
+		uint8_t unit[TCP_UNITS];         // message lengths, oldest at uhead
+		uint8_t uhead, units;
+		uint8_t sent;                    // bytes of the oldest message sent
+		uint8_t drops;                   // messages dropped since the last send
+		uint16_t dropped;                // messages dropped, for 1q
+#ifdef HAS_RF_LATENCY
+		uint32_t since;                  // micros() when it was last empty, XL
+#endif
+	} tcp_queue_t;
 #endif
 
 class EthernetClass {
@@ -36,7 +62,7 @@ public:
 	extern uint8_t eth_initialized;
     struct timer periodic_timer, arp_timer;
 #else
-  void putChar(char data); //von tcp_link.h uebernommen
+  void write(const char *buf, uint8_t len); // display output, one line
 	uip_ipaddr_t 	uip_hostaddr;
 	struct uip_eth_addr uip_ethaddr = {{0,0,0,0,0,0}};
 	uint8_t eth_debug;
@@ -64,13 +90,27 @@ private:
 #ifdef ESP8266
 	uint8_t now_in_ota;
 	
-	// buffers for receiving and sending data
-	char packetBuffer[UDP_TX_PACKET_MAX_SIZE + 1]; //buffer to hold incoming packet,
-	char  ReplyBuffer[80];// = "acknowledged\r\n";       // a string to send back
-	uint8_t ReplyPos;
 	WiFiUDP Udp;
+	// RF reports for the Wiu/WiU destination, several lines per datagram
+	char udp_buf[UDP_MTU];
+	uint16_t udp_len;
+	uint16_t udp_seq;                 // first line of every datagram: #<seq>
+	uint32_t udp_since;               // millis() of the oldest line
+	uint32_t udp_sent;                // datagrams, for 1q
+	uint16_t udp_reply;               // bytes of the reply to a UDP command
+	tty_line_t UdpLine;               // command line of the UDP input
+	uint8_t udp_on(void);
+	void udp_put(const char *buf, uint8_t len);
+	void udp_flush(void);
+	void udp_input(void);
 	WiFiServerExt server;
 	WiFiClient Tcp[TCP_MAX];  // 
+	tcp_queue_t TcpQ[TCP_MAX];
+	tty_line_t TcpLine[TCP_MAX];    // command line of each client
+	void queue_put(uint8_t i, const char *buf, uint8_t len);
+	uint8_t queue_drop(tcp_queue_t *q);
+	void queue_send(uint8_t i);
+	void queue_show(void);
 	uint8_t tcp_initialized;
 	int ip_active;
 	uint16_t tcplink_port;
@@ -22,6 +22,7 @@ FastRFClass::func(char *in)
 
   } else if(in[1] == 's') {         // Send
 
+    RfSend.tx_wait();
     CC1100_ASSERT;
     CC1100.cc1100_sendbyte(CC1100_WRITE_BURST | CC1100_TXFIFO);
     CC1100.cc1100_sendbyte( len-2 );
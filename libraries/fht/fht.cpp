@@ -1,4 +1,5 @@
-//#include <string.h>
+#include <stdlib.h>
+#include <string.h>
 //#include <EEPROM.h>
 #include "board.h"
 #include "stringfunc.h"
@@ -58,8 +59,7 @@ void FHTClass::fht_display_buf(uint8_t ptr[])
 #endif
 
   DC('T');
-  for(uint8_t i = 0; i < 5; i++)
-    DH2(ptr[i]);
+  display.hexbuf(ptr, 5);
   if(tx_report & REP_RSSI)
     DH2(250);
   DNL();
@@ -68,6 +68,67 @@ void FHTClass::fht_display_buf(uint8_t ptr[])
 #endif
 }
 
+// Queue a 5 byte message, its T report follows when it is on air
+void FHTClass::fht_send(uint8_t *hb)
+{
+  RfSend.addParityAndSendData(hb, 5, FHT_CSUM_START, 1, TXQ_HIGH);
+#ifdef HAS_RF_TX_TIMER
+  if(!RfSend.txq_seq)                  // LOVF
+    return;
+  if(fht_txrep_n == FHT_TX_REPORTS) {  // the oldest goes unreported
+    fht_txrep_n--;
+    memmove(fht_txrep, fht_txrep+1, fht_txrep_n * sizeof(fht_txrep[0]));
+  }
+  fht_txrep[fht_txrep_n].seq = RfSend.txq_seq;
+  memcpy(fht_txrep[fht_txrep_n].msg, hb, 5);
+  fht_txrep_n++;
+#else
+  fht_display_buf(hb);
+#endif
+}
+
+void FHTClass::fht_task(void)
+{
+#ifdef HAS_FHT_80b
+  if(fht80b_tx == FHT_TX_WAIT
+#ifdef HAS_RF_TX_TIMER
+     && RfSend.tx_state == TX_IDLE
+#endif
+    ) {
+    CC1100.ccStrobe(CC1100_SIDLE);             // Don't let the CC1101 to disturb us
+    fht80b_txtime = millis();
+    fht80b_tx = FHT_TX_DELAY;
+  }
+
+  // avg. FHT packet is 75ms.
+  // The first delay is larger, as we don't know if we received the first or
+  // second FHT actuator message.
+  if(fht80b_tx == FHT_TX_DELAY && millis() - fht80b_txtime >=
+                               (fht80b_txbuf[2]==FHT_CAN_XMIT ? 155u : 75u)) {
+    fht80b_tx = FHT_TX_IDLE;
+    fht_send(fht80b_txbuf);
+#ifdef HAS_RF_TX_TIMER
+    if(RfSend.tx_state == TX_IDLE)             // else RfSend.task() does it
+#endif
+    CC1100.ccRX();                             // reception might be lost due to LOVF
+  }
+#endif
+
+#ifdef HAS_RF_TX_TIMER
+  for(uint8_t i = 0; i < fht_txrep_n; ) {
+    uint8_t st = RfSend.tx_status(fht_txrep[i].seq);
+    if(st == TXS_QUEUED) {
+      i++;
+      continue;
+    }
+    if(st == TXS_SENT)
+      fht_display_buf(fht_txrep[i].msg);
+    fht_txrep_n--;
+    memmove(fht_txrep+i, fht_txrep+i+1, (fht_txrep_n-i) * sizeof(fht_txrep[0]));
+  }
+#endif
+}
+
 void FHTClass::fht_init(void)
 {
   fht_hc0 = FNcol.erb(EE_FHTID);
@@ -79,7 +140,7 @@ void FHTClass::fht_init(void)
 
 #ifdef HAS_FHT_80b
   fht80b_reset_state();
-  fht80b_initbuf();
+  fht80b_initbuf(FNcol.erb(EE_FHTBUF_DEVS));
 #endif
 
 #ifdef HAS_FHT_TF
@@ -121,6 +182,12 @@ void FHTClass::fhtsend(char *in)
 
     } else if(hb[0] == 3) {            // Return the remaining fht buffer
       DH2(fht_bufspace());
+
+    } else if(hb[0] == 4) {            // Return the backlog per FHT
+      fht80b_backlog();
+
+    } else if(hb[0] == 5) {            // Number of FHT slots
+      fht80b_devs(hb, l);
 #endif
 
 #ifdef HAS_FHT_8v
@@ -223,11 +290,11 @@ void FHTClass::fhtsend(char *in)
       if(doSync) {
         // 1x sync x0c and afterwards 1x finish 0xf 
         // -> sync is handled by 09_cul_fhttk.pm module
-        RfSend.addParityAndSendData(fhttf, 4, FHT_CSUM_START, 2);
+        RfSend.addParityAndSendData(fhttf, 4, FHT_CSUM_START, 2, TXQ_HIGH);
         fhttf[3] = 0x0f; // finish
-        RfSend.addParityAndSendData(fhttf, 4, FHT_CSUM_START, 2);
+        RfSend.addParityAndSendData(fhttf, 4, FHT_CSUM_START, 2, TXQ_HIGH);
         fhttf[3] = 0x02; // state closed
-        RfSend.addParityAndSendData(fhttf, 4, FHT_CSUM_START, 2);
+        RfSend.addParityAndSendData(fhttf, 4, FHT_CSUM_START, 2, TXQ_HIGH);
       }
 
     } else { // value has changed, seek for corresp. TF and change the value
@@ -251,7 +318,7 @@ void FHTClass::fhtsend(char *in)
      hb[1]==fht_hc1) {                 // FHT8v mode commands
 
     if(hb[3] == FHT8V_CMD_PAIR) {
-      RfSend.addParityAndSend(in, FHT_CSUM_START, 2);
+      RfSend.addParityAndSend(in, FHT_CSUM_START, 2, TXQ_HIGH);
 
     } else if(hb[3] == FHT8V_CMD_SYNC){// start syncprocess for _all_ 8v's
       fht8v_ctsync = hb[4];            // use it to shorten the sync-time
@@ -330,7 +397,7 @@ void FHTClass::fht_tf_send(uint8_t index)
   send_tk_out[3] = fht_tf_buf[FHT_TF_DATA * index+3];
   
   // send data to FHT80b incl. checksum
-  RfSend.addParityAndSendData(send_tk_out, 4, FHT_CSUM_START, 1); 
+  RfSend.addParityAndSendData(send_tk_out, 4, FHT_CSUM_START, 1, TXQ_HIGH); 
   }
 }
 #endif
@@ -365,8 +432,7 @@ void FHTClass::fht8v_timer(void)
       hb[4] = fht8v_buf[2*i+1];
 
     }
-    RfSend.addParityAndSendData(hb, 5, FHT_CSUM_START, 1);
-    fht_display_buf(hb);
+    fht_send(hb);
 
   }
   //Serial.println(millis());
@@ -402,25 +468,19 @@ const PROGMEM uint8_t fht80b_state_tbl[] = {
 };
 #define RCV_OFFSET 6
 
+// The answer goes out from fht_task(), after the FHT is ready to listen
 void FHTClass::fht80b_sendpacket(void)
 {
-  CC1100.ccStrobe(CC1100_SIDLE);               // Don't let the CC1101 to disturb us
-
-  // avg. FHT packet is 75ms.
-  // The first delay is larger, as we don't know if we received the first or
-  // second FHT actuator message.
-  MYDELAY.my_delay_ms(fht80b_out[2]==FHT_CAN_XMIT ? 155 : 75);
-  RfSend.addParityAndSendData(fht80b_out, 5, FHT_CSUM_START, 1);
-  CC1100.ccRX();                               // reception might be lost due to LOVF
-
-  fht_display_buf(fht80b_out);
+  memcpy(fht80b_txbuf, fht80b_out, 5);
+  fht80b_tx = FHT_TX_WAIT;
+  fht_task();
 }
 
 void FHTClass::fht80b_reset_state(void)
 {
   fht80b_state = 0;
   fht80b_ldata = 0;
-  fht80b_bufoff = 3;
+  fht80b_bufoff = 1;
   fht80b_timeout = FHT_TIMER_DISABLED;
 }
 
@@ -572,106 +632,212 @@ void FHTClass::fht_hook(uint8_t *fht_in)
 
 ///////////////////////
 // FHT buffer management functions
-// "Dumb" FHZ model: store every incoming message in a separate buffer.
-// Transmit only one buffer at a time.  Delete a complete buffer if a
-// transmission is complete.
-uint8_t* FHTClass::fht_lookbuf(uint8_t *buf)
+// Every FHT80b housecode has its own slot, found by a hash of the housecode.
+// Each incoming message is stored separately in the slot of its FHT. Only
+// the first message of a slot is transmitted in a conversation, and it is
+// deleted when the transmission is complete.
+uint8_t FHTClass::fht_hash(uint8_t *buf)
 {
-  uint8_t *p = fht80b_buf;
-  uint8_t *bmax = fht80b_buf+FHTBUF_SIZE;
+  return (buf[0]*31 + buf[1]) & fht80b_idxmask;
+}
 
-  while(p[0] && p < bmax) {
-    if(buf != 0 && p[1] == buf[0] && p[2] == buf[1])
-      return p;
-    p += p[0];
+fht80b_dev_t* FHTClass::fht_lookbuf(uint8_t *buf)
+{
+  if(!fht80b_devcnt)
+    return 0;
+  uint8_t h = fht_hash(buf);
+  while(fht80b_idx[h]) {
+    fht80b_dev_t *d = fht80b_dev + fht80b_idx[h]-1;
+    if(d->hc[0] == buf[0] && d->hc[1] == buf[1])
+      return d;
+    h = (h+1) & fht80b_idxmask;
+  }
+  return 0;
+}
+
+// Return the slot for the housecode, take a free one if it has none
+fht80b_dev_t* FHTClass::fht_newbuf(uint8_t *buf)
+{
+  fht80b_dev_t *d = fht_lookbuf(buf);
+  if(d)
+    return d;
+  for(uint8_t i = 0; i < fht80b_devcnt; i++) {
+    d = fht80b_dev+i;
+    if(d->len)
+      continue;
+    d->hc[0] = buf[0];
+    d->hc[1] = buf[1];
+    uint8_t h = fht_hash(buf);
+    while(fht80b_idx[h])
+      h = (h+1) & fht80b_idxmask;
+    fht80b_idx[h] = i+1;
+    return d;
+  }
+  return 0;
+}
+
+// Free slots leave gaps in the probe sequences, so rebuild the index
+void FHTClass::fht80b_reindex(void)
+{
+  memset(fht80b_idx, 0, fht80b_idxmask+1);
+  for(uint8_t i = 0; i < fht80b_devcnt; i++) {
+    if(!fht80b_dev[i].len)
+      continue;
+    uint8_t h = fht_hash(fht80b_dev[i].hc);
+    while(fht80b_idx[h])
+      h = (h+1) & fht80b_idxmask;
+    fht80b_idx[h] = i+1;
   }
-  if(p > bmax)
-    p = bmax;
-  return (buf ? 0 : p);
 }
 
 void FHTClass::fht_delbuf(uint8_t *buf)
 {
-  uint8_t *p = fht_lookbuf(buf);
-  if(p == 0)
+  fht80b_dev_t *d = fht_lookbuf(buf);
+  if(d == 0 || !d->len)
     return;
 
-  uint8_t sz = p[0];
-  uint8_t *lim = fht80b_buf+FHTBUF_SIZE-sz; 
-
-  while(p < lim) {
-    p[0]=p[sz];
-    p++;
-  }
-  p[0] = 0;
+  uint8_t sz = 1+2*d->buf[0];
+  d->len -= sz;
+  memmove(d->buf, d->buf+sz, d->len);
+  if(!d->len)
+    fht80b_reindex();
 }
 
 
 uint8_t FHTClass::fht_addbuf(char *in)
 {
-  uint8_t *p = fht_lookbuf(0);  // get a free slot
-  uint8_t l = strlen(in+1)/2+1; // future size of the message
-  uint8_t i, j;
+  uint8_t hc[2], i;
+  uint8_t n = (strlen(in+1)/2-2)/2;    // cmd/arg pairs
+  uint8_t sz = 1+2*n;
 
-  if((p+l-fht80b_buf) > FHTBUF_SIZE)
+  if(sz > FHTBUF_DEVSIZE || STRINGFUNC.fromhex(in+1, hc, 2) != 2)
+    return 0;
+  fht80b_dev_t *d = fht_newbuf(hc);
+  if(d == 0 || d->len+sz > FHTBUF_DEVSIZE)
     return 0;
 
-  p[0] = l;
-  for(i=1, j=1 ; j < l; i+=2, j++) {
-    STRINGFUNC.fromhex(in+i, p+j, 1);
-    if(j > 2 && ((j&1) == 0)) {
-      if(p[j-1] == FHT_MINUTE) 
-        fht80b_minute = p[j];
-    }
-  }
-  if(p < (fht80b_buf+FHTBUF_SIZE))
-    p[j] = 0;
+  uint8_t *p = d->buf+d->len;
+  p[0] = n;
+  STRINGFUNC.fromhex(in+5, p+1, 2*n);
+  for(i = 1; i < sz; i += 2)
+    if(p[i] == FHT_MINUTE)
+      fht80b_minute = p[i+1];
+  d->len += sz;
   return 1;
 }
 
+// Free bytes in all slots, at most 0xff
 uint8_t FHTClass::fht_bufspace(void)
 {
-  return (FHTBUF_SIZE - (uint8_t)(fht_lookbuf(0)-fht80b_buf));
+  uint16_t sp = 0;
+  for(uint8_t i = 0; i < fht80b_devcnt; i++)
+    sp += FHTBUF_DEVSIZE-fht80b_dev[i].len;
+  return (sp > 0xff ? 0xff : sp);
 }
 
 uint8_t FHTClass::fht_getbuf(uint8_t *buf)
 {
-  uint8_t *p = fht_lookbuf(buf);
-  if(p == 0 || p[0] <= fht80b_bufoff)
+  fht80b_dev_t *d = fht_lookbuf(buf);
+  if(d == 0 || !d->len || 1+2*d->buf[0] <= fht80b_bufoff)
     return 0;
-  buf[2] = p[fht80b_bufoff];
+  buf[2] = d->buf[fht80b_bufoff];
   buf[3] = 0x79;
-  buf[4] = p[fht80b_bufoff+1];
+  buf[4] = d->buf[fht80b_bufoff+1];
   return 1;
 }
 
-void FHTClass::fht80b_initbuf()
+// Allocate n slots and the index on the heap, and clear them
+void FHTClass::fht80b_initbuf(uint8_t n)
 {
-  fht80b_buf[0] = 0;
+  if(n < FHTBUF_DEVS_MIN || n > FHTBUF_DEVS_MAX)
+    n = FHTBUF_DEVICES;
+
+  if(n != fht80b_devcnt || !fht80b_dev) {
+    free(fht80b_dev);
+    free(fht80b_idx);
+    uint16_t m = 1;                     // 256 for FHTBUF_DEVS_MAX
+    while(m < 2*n)
+      m <<= 1;
+    fht80b_dev = (fht80b_dev_t *)malloc(n * sizeof(fht80b_dev_t));
+    fht80b_idx = (uint8_t *)malloc(m);
+    if(!fht80b_dev || !fht80b_idx) {
+      free(fht80b_dev);
+      free(fht80b_idx);
+      fht80b_dev = 0;
+      fht80b_idx = 0;
+      n = 0;
+    }
+    fht80b_devcnt = n;
+    fht80b_idxmask = m-1;
+  }
+  for(uint8_t i = 0; i < fht80b_devcnt; i++)
+    fht80b_dev[i].len = 0;
+  if(fht80b_idx)
+    memset(fht80b_idx, 0, fht80b_idxmask+1);
 }
 
 void FHTClass::fht80b_print(uint8_t full)
 {
-  uint8_t *p = fht80b_buf;
-
-  if(!p[0])
-    DS_P( PSTR("N/A") );
-  while(p[0] && (p < (fht80b_buf+FHTBUF_SIZE))) {
-    if(p != fht80b_buf)
-      DC(' ');
-    uint8_t i = 1;
-    DH2(p[i++]);
-    DH2(p[i++]);
-    if(full) {
-      DC(':');
-      while(i < p[0]) {
-        if(i > 3 && (i&1))
-          DC(',');
-        DH2(p[i++]);
+  uint8_t na = 0;
+
+  for(uint8_t i = 0; i < fht80b_devcnt; i++) {
+    fht80b_dev_t *d = fht80b_dev+i;
+    uint8_t *p = d->buf;
+    while(p < d->buf+d->len) {
+      if(na++)
+        DC(' ');
+      DH2(d->hc[0]);
+      DH2(d->hc[1]);
+      uint8_t n = *p++;
+      if(full) {
+        DC(':');
+        for(uint8_t j = 0; j < 2*n; j++) {
+          if(j && !(j&1))
+            DC(',');
+          DH2(p[j]);
+        }
       }
+      p += 2*n;
     }
-    p += p[0];
   }
+  if(!na)
+    DS_P( PSTR("N/A") );
+}
+
+// T04: messages waiting per FHT80b housecode
+void FHTClass::fht80b_backlog(void)
+{
+  uint8_t na = 0;
+
+  for(uint8_t i = 0; i < fht80b_devcnt; i++) {
+    fht80b_dev_t *d = fht80b_dev+i;
+    if(!d->len)
+      continue;
+    uint8_t cnt = 0;
+    for(uint8_t o = 0; o < d->len; o += 1+2*d->buf[o])
+      cnt++;
+    if(na++)
+      DC(' ');
+    DH2(d->hc[0]);
+    DH2(d->hc[1]);
+    DC(':');
+    DH2(cnt);
+    DC('/');
+    DH2(FHTBUF_DEVSIZE-d->len);
+  }
+  if(!na)
+    DS_P( PSTR("N/A") );
+}
+
+// T05: report, T05nn: set and save the number of slots (hex), clears them
+void FHTClass::fht80b_devs(uint8_t *hb, uint8_t l)
+{
+  if(l == 2) {
+    fht80b_reset_state();
+    fht80b_initbuf(hb[1]);
+    FNcol.ewb(EE_FHTBUF_DEVS, fht80b_devcnt);
+  }
+  DH2(fht80b_devcnt);
 }
 
 #endif
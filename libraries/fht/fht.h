@@ -16,6 +16,11 @@
 
 #define FHT_TIMER_DISABLED   0xff
 
+#define FHT_TX_IDLE    0
+#define FHT_TX_WAIT    1    // 80b answer: until RfSend is off the air
+#define FHT_TX_DELAY   2    // 80b answer: deaf until the FHT listens
+#define FHT_TX_REPORTS 8    // queued messages waiting for their T report
+
 #define FHT_CSUM_START   12
 
 #define FHT_8V_NUM         8    // Needs 2 byte per 8v. For sync must by <14
@@ -25,6 +30,20 @@
 #define FHT_TF_DATA        4  // 4 bytes per FHT 80 TF (HH HH AA BB)
 #define FHT_TF_NUM         4  // supported window FHT 80 TF
 #define FHT_TF_DISABLED 0xff  // TF not used
+#define FHTBUF_DEVS_MIN    1    // T05: slots for FHT80b housecodes
+#define FHTBUF_DEVS_MAX  127
+
+#ifdef HAS_FHT_80b
+// One slot per FHT80b housecode. buf holds the queued messages as
+// [npairs, cmd, arg, cmd, arg...], the first one goes out with the next
+// conversation.
+typedef struct {
+  uint8_t hc[2];
+  uint8_t len;                         // used bytes in buf, 0: slot is free
+  uint8_t buf[FHTBUF_DEVSIZE];
+} fht80b_dev_t;
+#endif
+
 #ifdef HAS_FHT_8v
 #  define FHT8V_CMD_SET  0x26
 #  define FHT8V_CMD_SYNC 0x2c
@@ -40,11 +59,13 @@ public:
 	void fhtsend(char *in);
 	void fht_hook(uint8_t *in);
 	void fht_init(void);
+	void fht_task(void);   // Sched: 80b answer delay, T reports once sent
 #ifdef HAS_FHT_80b
 	void fht80b_timer(void);
     uint8_t fht80b_timeout;
     uint8_t fht80b_minute;
     uint8_t fht80b_state;    // 80b state machine
+    uint8_t fht80b_tx;       // FHT_TX_*, fht80b_timeout waits for IDLE
 #endif
 #ifdef HAS_FHT_TF
 	void fht_tf_timer(uint8_t ind); // fht TF timer method
@@ -58,21 +79,39 @@ public:
 
 private:
 	void fht_display_buf(uint8_t ptr[]);
+	void fht_send(uint8_t *hb);
+#ifdef HAS_RF_TX_TIMER
+	struct {
+	  uint16_t seq;            // RfSend.txq_seq
+	  uint8_t msg[5];
+	} fht_txrep[FHT_TX_REPORTS];
+	uint8_t fht_txrep_n;
+#endif
 #ifdef HAS_FHT_80b
 	uint8_t fht80b_ldata;    // last data waiting for ack
 	uint8_t fht80b_out[6];   // Last sent packet. Reserve 1 byte for checksum
+	uint8_t fht80b_txbuf[6]; // fht80b_out when the answer was scheduled
+	uint32_t fht80b_txtime;  // millis() at the start of FHT_TX_DELAY
 	uint8_t fht80b_repeatcnt;
-	uint8_t fht80b_buf[FHTBUF_SIZE];
-	uint8_t fht80b_bufoff;   // offset in the current fht80b_buf
+	fht80b_dev_t *fht80b_dev;  // heap, fht80b_devcnt slots
+	uint8_t *fht80b_idx;       // hash of the housecode -> slot+1, 0: empty
+	uint8_t fht80b_devcnt;
+	uint8_t fht80b_idxmask;
+	uint8_t fht80b_bufoff;     // offset in the first message of the slot
 
 	void    fht80b_sendpacket(void);
 	void    fht80b_send_repeated(void);
 	void    fht80b_print(uint8_t level);
-	void    fht80b_initbuf(void);
+	void    fht80b_initbuf(uint8_t n);
 	void    fht_delbuf(uint8_t *buf);
 	uint8_t fht_addbuf(char *in);
 	uint8_t fht_getbuf(uint8_t *buf);
-	uint8_t* fht_lookbuf(uint8_t *buf);
+	fht80b_dev_t* fht_lookbuf(uint8_t *buf);
+	fht80b_dev_t* fht_newbuf(uint8_t *buf);
+	uint8_t fht_hash(uint8_t *buf);
+	void    fht80b_reindex(void);
+	void    fht80b_backlog(void);
+	void    fht80b_devs(uint8_t *hb, uint8_t l);
 	void    fht80b_reset_state(void);
 	uint8_t fht_bufspace(void);
 #endif 
@@ -22,6 +22,7 @@
 #include "clock.h"
 #include "fastrf.h"
 #include "rf_router.h"
+#include "rf_receive.h"                 // REPTIME
 #ifdef HAS_ETHERNET
 #  include "ethernet.h"
 #endif
@@ -169,6 +170,8 @@ void FNCOLLECTIONClass::read_eeprom(char *in)
     } else if(in[2] == 'k') { display_string(EE_WPA_KEY, EE_STR_LEN);
     } else if(in[2] == 'D') { display_string(EE_NAME, EE_STR_LEN);
     } else if(in[2] == 'O') { display_ee_ip4(EE_OTA_SERVER);
+    } else if(in[2] == 'u') { display_ee_ip4(EE_UDP_ADDR);
+    } else if(in[2] == 'U') { DU(erw(EE_UDP_PORT),0);
 #   endif
     }
   } else 
@@ -281,6 +284,8 @@ void FNCOLLECTIONClass::write_eeprom(char *in, bool commit)
 					return;
 			}
     } else if(in[2] == 'O') { d=4; STRINGFUNC.fromip (in+3,hb,4); addr=EE_OTA_SERVER;
+    } else if(in[2] == 'u') { d=4; STRINGFUNC.fromip (in+3,hb,4); addr=EE_UDP_ADDR;
+    } else if(in[2] == 'U') { d=2; STRINGFUNC.fromdec(in+3,hb);   addr=EE_UDP_PORT;
 #   endif
     }
     for(uint8_t i = 0; i < d; i++)
@@ -355,6 +360,21 @@ void FNCOLLECTIONClass::eeprom_factory_reset(char *in)
   ewb(EE_RF_ROUTER_ROUTER, 0, false);
   ewb(EE_REQBL, 0, false);
   ewb(EE_LED, 2, false);
+  ewb(EE_RCV_BUCKETS, RCV_BUCKETS, false);
+  ewb(EE_REPTIME, REPTIME, false);
+  ewb(EE_RF_FRAME, 0, false);
+  ewb(EE_RF_STAMP, 0, false);
+  ewb(EE_TTY_ECHO, 1, false);
+#ifdef HAS_FHT_80b
+  ewb(EE_FHTBUF_DEVS, FHTBUF_DEVICES, false);
+#endif
+#ifdef HAS_MQTT
+  for(uint8_t k = 0; k < 4; k++)
+    ewb(EE_MQTT_BROKER+k, 0, false);            // off
+  ewb(EE_MQTT_PORT, 1883 & 0xff, false);
+  ewb(EE_MQTT_PORT+1, 1883 >> 8, false);
+  ewb(EE_MQTT_QOS, 0, false);
+#endif
 
 # ifdef HAS_LCD
     ewb(EE_CONTRAST,   0x40, false);
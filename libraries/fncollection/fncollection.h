@@ -104,6 +104,28 @@ extern FNCOLLECTIONClass FNcol;
 #	define EE_FS_LAST           EE_LCD_LAST
 #endif
 
+#define EE_RCV_BUCKETS       EE_FS_LAST                         // XB
+#define EE_REPTIME           (EE_RCV_BUCKETS+1)                 // XR
+#define EE_FHTBUF_DEVS       (EE_REPTIME+1)                     // T05
+#define EE_RF_FRAME          (EE_FHTBUF_DEVS+1)                 // XW
+#define EE_RF_STAMP          (EE_RF_FRAME+1)                    // XT
+#define EE_TTY_ECHO          (EE_RF_STAMP+1)                    // si
+#if defined(HAS_ETHERNET) && defined(ESP8266)
+# define EE_UDP_ADDR         (EE_TTY_ECHO+1)                    // Wiu, 4 bytes
+# define EE_UDP_PORT         (EE_UDP_ADDR+4)                    // WiU, 2 bytes
+# define EE_UDP_LAST         (EE_UDP_PORT+2)
+#else
+# define EE_UDP_LAST         (EE_TTY_ECHO+1)
+#endif
+#ifdef HAS_MQTT
+# define EE_MQTT_BROKER      EE_UDP_LAST                        // Qb, 4 bytes
+# define EE_MQTT_PORT        (EE_MQTT_BROKER+4)                 // Qb, 2 bytes
+# define EE_MQTT_QOS         (EE_MQTT_PORT+2)                   // Qq
+# define EE_RF_LAST          (EE_MQTT_QOS+1)
+#else
+# define EE_RF_LAST          EE_UDP_LAST
+#endif
+
 extern uint8_t led_mode;
 
 #endif
@@ -0,0 +1,55 @@
+#include <string.h>
+#include "board.h"
+#include "display.h"
+#include "histogram.h"
+
+void Histogram::clear(void)
+{
+  memset(this, 0, sizeof(*this));
+}
+
+void Histogram::add(uint32_t us)
+{
+  uint8_t i = 0;
+  for(uint32_t v = us; v && i < HIST_BUCKETS-1; v >>= 1)
+    i++;
+  cnt[i]++;
+  n++;
+  sum += us;
+  if(us > max)
+    max = us;
+}
+
+// Upper bound of the bucket holding the p-th percentile, at most max, in us
+uint32_t Histogram::percentile(uint8_t p)
+{
+  uint32_t want = ((uint64_t)n * p + 99) / 100, seen = 0;
+
+  for(uint8_t i = 0; i < HIST_BUCKETS-1; i++) {
+    seen += cnt[i];
+    if(seen >= want && seen)
+      return (((uint32_t)1 << i) - 1 < max) ? ((uint32_t)1 << i) - 1 : max;
+  }
+  return max;
+}
+
+// n:<count> avg:<us> p99:<us> max:<us> [<upper bound>:<count>...]
+void Histogram::print(uint8_t buckets)
+{
+  DS("n:");    DU(n, 0);
+  DS(" avg:"); DU(n ? (uint32_t)(sum / n) : 0, 0);
+  DS(" p99:"); DU(percentile(99), 0);
+  DS(" max:"); DU(max, 0);
+  if(!buckets)
+    return;
+  for(uint8_t i = 0; i < HIST_BUCKETS; i++) {
+    if(!cnt[i])
+      continue;
+    DC(' ');
+    if(i == HIST_BUCKETS-1)
+      DC('>');
+    DU(i ? ((uint32_t)1 << (i == HIST_BUCKETS-1 ? i-1 : i)) - 1 : 0, 0);
+    DC(':');
+    DU(cnt[i], 0);
+  }
+}
@@ -0,0 +1,22 @@
+#ifndef _HISTOGRAM_H
+#define _HISTOGRAM_H
+
+#include <stdint.h>
+
+// Durations in us, bucket i counts 2^(i-1) <= us < 2^i (bucket 0: 0us),
+// the last one everything from 2^(HIST_BUCKETS-2) us (~4s) on.
+#define HIST_BUCKETS 24
+
+class Histogram {
+public:
+	uint32_t cnt[HIST_BUCKETS];
+	uint32_t n, max;
+	uint64_t sum;
+
+	void clear(void);
+	void add(uint32_t us);
+	uint32_t percentile(uint8_t p);
+	void print(uint8_t buckets = 1);
+};
+
+#endif
@@ -0,0 +1,41 @@
+#include "board.h"
+#include "display.h"
+#include "latency.h"
+
+static const char stage_name[LAT_STAGES][7] = {
+  "wait", "decode", "check", "output", "total", "tcp"
+};
+
+void LatencyClass::clear(void)
+{
+  for(uint8_t i = 0; i < LAT_STAGES; i++)
+    hist[i].clear();
+}
+
+// All times are micros() values
+void LatencyClass::frame(uint32_t silence, uint32_t start, uint32_t decoded,
+                         uint32_t queued, uint32_t written)
+{
+  hist[LAT_WAIT  ].add(start   - silence);
+  hist[LAT_DECODE].add(decoded - start);
+  hist[LAT_CHECK ].add(queued  - decoded);
+  hist[LAT_OUTPUT].add(written - queued);
+  hist[LAT_TOTAL ].add(written - silence);
+}
+
+// XL: one line per stage, XLr: report and clear
+void LatencyClass::func(char *in)
+{
+  for(uint8_t i = 0; i < LAT_STAGES; i++) {
+    DS((char *)stage_name[i]);
+    DC(' ');
+    hist[i].print();
+    DNL();
+  }
+  if(in[2] == 'r')
+    clear();
+}
+
+#if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_LATENCY)
+LatencyClass Latency;
+#endif
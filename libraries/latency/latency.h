@@ -0,0 +1,32 @@
+#ifndef _LATENCY_H
+#define _LATENCY_H
+
+#include <stdint.h>
+#include "histogram.h"
+
+// XL: stages of a reported SlowRF message, from the silence at its end
+#define LAT_WAIT     0                  // silence -> analyze start
+#define LAT_DECODE   1                  // analyze start -> decoded
+#define LAT_CHECK    2                  // decoded -> first byte queued
+#define LAT_OUTPUT   3                  // first byte -> last byte written
+#define LAT_TOTAL    4                  // silence -> last byte written
+#define LAT_TCP      5                  // TCP queue filled -> sent
+#define LAT_STAGES   6
+
+class LatencyClass {
+public:
+	void clear(void);
+	void func(char *in);
+	void frame(uint32_t silence, uint32_t start, uint32_t decoded,
+	           uint32_t queued, uint32_t written);
+	void add(uint8_t stage, uint32_t us) { hist[stage].add(us); }
+
+private:
+	Histogram hist[LAT_STAGES];
+};
+
+#if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_LATENCY)
+extern LatencyClass Latency;
+#endif
+
+#endif
@@ -0,0 +1,486 @@
+#include <string.h>
+#include "board.h"
+#include "display.h"
+#include "fncollection.h"
+#include "stringfunc.h"
+#include "ttydata.h"
+#include "mqtt.h"
+
+// Where the address is in a report, for the topic
+static const struct {
+  char type;
+  uint8_t off, len;
+} addr_tab[] = {
+  { 'F', 1, 6 },                        // FS20: housecode, button
+  { 'T', 1, 4 },                        // FHT: housecode
+  { 'E', 1, 4 },                        // EM: type, address
+  { 'H', 1, 4 },                        // HMS: housecode
+  { 'K', 1, 2 },                        // KS300/S300TH: type, address
+  { 'A', 9, 6 },                        // AskSin: sender
+  { 'Z', 9, 6 },                        // MAX!: sender
+  { 0, 0, 0 }
+};
+
+MqttClass::MqttClass()
+{
+  state = MQTT_OFF;
+  qlen = qsent = npkt = 0;
+  rxlen = 0;
+  rxskip = 0;
+  outlen = 0;
+  replying = 0;
+  next_id = 0;
+  backoff = MQTT_BACKOFF_MIN;
+  published = dropped = reconnects = 0;
+  cmd.len = cmd.toolong = 0;
+}
+
+// Q: state, Qb<ip>[:<port>]: broker, 0.0.0.0 switches MQTT off,
+// Qq<n>: QoS of the reports (0 or 1). Saved in the EEPROM.
+void MqttClass::func(char *in)
+{
+  if(in[1] == 'b') {
+    uint8_t ip[4] = { 0, 0, 0, 0 }, hb[2];
+    char *p = strchr(in+2, ':');
+    if(p)
+      *p++ = 0;
+    STRINGFUNC.fromip(in+2, ip, 4);
+    for(uint8_t k = 0; k < 4; k++)
+      FNcol.ewb(EE_MQTT_BROKER+k, ip[k], false);
+    if(p) {
+      STRINGFUNC.fromdec(p, hb);
+      FNcol.ewb(EE_MQTT_PORT, hb[0], false);
+      FNcol.ewb(EE_MQTT_PORT+1, hb[1], false);
+    }
+    FNcol.ewc(true);
+    client.stop();
+    state = MQTT_OFF;                   // task() connects to the new one
+  } else if(in[1] == 'q') {
+    if(in[2])
+      FNcol.ewb(EE_MQTT_QOS, in[2] != '0');
+  }
+  show();
+}
+
+void MqttClass::show(void)
+{
+  static const char st[][8] = { "off", "wait", "connack", "up" };
+
+  DS(st[state]); DC(' ');
+  for(uint8_t k = 0; k < 4; k++) {
+    DU(FNcol.erb(EE_MQTT_BROKER+k),0);
+    DC(k < 3 ? '.' : ':');
+  }
+  DU(port(),0);
+  DS(" qos:");        DU(qos(),0);
+  DS(" queued:");     DU(qlen,0);
+  DS(" published:");  DU(published,0);
+  DS(" dropped:");    DU(dropped,0);
+  DS(" reconnects:"); DU(reconnects,0);
+  DNL();
+}
+
+// 0.0.0.0 is off, so is 255.x: an upgrade from a version without MQTT
+// leaves the fields erased, the magic reset does not write them.
+uint8_t MqttClass::broker_on(void)
+{
+  uint8_t a = FNcol.erb(EE_MQTT_BROKER);
+  return a && a != 0xff;
+}
+
+// 0 and 0xFFFF (erased, as broker_on()) select the default
+uint16_t MqttClass::port(void)
+{
+  uint16_t p = FNcol.erw(EE_MQTT_PORT);
+  return p && p != 0xFFFF ? p : MQTT_PORT_DEFAULT;
+}
+
+uint8_t MqttClass::qos(void)
+{
+  return FNcol.erb(EE_MQTT_QOS) == 1;
+}
+
+void MqttClass::task(void)
+{
+  uint32_t now = millis();
+
+  if(!broker_on()) {
+    if(state != MQTT_OFF) {
+      client.stop();
+      state = MQTT_OFF;
+      qlen = qsent = npkt = 0;
+    }
+    return;
+  }
+  if(state == MQTT_OFF) {
+    uint8_t k = 0;
+#ifdef EE_NAME
+    while(k < MQTT_NAME_LEN-1 && (name[k] = FNcol.erb(EE_NAME+k)))
+      k++;
+#endif
+    name[k] = 0;
+    if(!k)
+      strcpy(name, "culfw");
+    backoff = MQTT_BACKOFF_MIN;
+    retry = now;
+    state = MQTT_WAIT;
+  }
+  if(state == MQTT_WAIT) {
+    if((int32_t)(now - retry) >= 0)
+      connect();
+    return;
+  }
+
+  if(!client.connected()) {
+    lost();
+    return;
+  }
+  receive();
+  if(state == MQTT_CONNACK && now - last_rx > MQTT_CONNACK_MS)
+    lost();
+  if(state != MQTT_UP)
+    return;
+  if(now - last_rx > MQTT_KEEPALIVE * 1500UL) {
+    lost();
+    return;
+  }
+  if(now - last_tx >= MQTT_KEEPALIVE * 500UL) {
+    uint8_t *p = reserve(2, 0);
+    if(p) {
+      p[0] = 0xC0;                      // PINGREQ
+      p[1] = 0;
+    }
+    last_tx = now;
+  }
+  send();
+}
+
+// Blocks up to MQTT_CONNECT_MS, a few ms, then backoff until the next try
+void MqttClass::connect(void)
+{
+  char host[16];
+  uint8_t l = strlen(name);
+
+  sprintf(host, "%u.%u.%u.%u", FNcol.erb(EE_MQTT_BROKER),
+          FNcol.erb(EE_MQTT_BROKER+1), FNcol.erb(EE_MQTT_BROKER+2),
+          FNcol.erb(EE_MQTT_BROKER+3));
+  client.setTimeout(MQTT_CONNECT_MS);
+  if(!client.connect(host, port())) {
+    lost();
+    return;
+  }
+  client.setNoDelay(true);
+  rxlen = 0;
+  rxskip = 0;
+  state = MQTT_CONNACK;
+  last_rx = millis();
+
+  uint8_t p[14 + MQTT_NAME_LEN] = {
+    0x10, (uint8_t)(12 + l),            // CONNECT
+    0, 4, 'M', 'Q', 'T', 'T', 4,
+    0x02,                               // clean session
+    0, MQTT_KEEPALIVE,
+    0, l                                // client id
+  };
+  memcpy(p + 14, name, l);
+  direct(p, 14 + l);
+}
+
+// Written QoS 0 packets are gone, QoS 1 ones are sent again as duplicates
+void MqttClass::lost(void)
+{
+  uint16_t src = 0, dst = 0;
+  uint8_t k = 0;
+
+  client.stop();
+  state = MQTT_WAIT;
+  retry = millis() + backoff;
+  backoff = backoff * 2 > MQTT_BACKOFF_MAX ? MQTT_BACKOFF_MAX : backoff * 2;
+
+  for(uint8_t i = 0; i < npkt; i++) {
+    uint16_t l = pkt[i].len;
+    if(!pkt[i].id && (pkt[i].sent || (q[src] & 0xF0) != 0x30)) {
+      src += l;
+      continue;
+    }
+    if(pkt[i].sent)
+      q[src] |= 0x08;                   // DUP
+    memmove(q + dst, q + src, l);
+    pkt[k] = pkt[i];
+    pkt[k++].sent = 0;
+    src += l;
+    dst += l;
+  }
+  npkt = k;
+  qlen = dst;
+  qsent = 0;
+}
+
+// CONNECT and SUBSCRIBE, before anything of the queue is written
+void MqttClass::direct(const uint8_t *p, uint8_t n)
+{
+  if(client.write(p, n) != n) {
+    lost();
+    return;
+  }
+  last_tx = millis();
+}
+
+// Room for a packet of n bytes at the end of the queue, 0 if it is full
+uint8_t *MqttClass::reserve(uint16_t n, uint16_t id)
+{
+  if(npkt == MQTT_QUEUE_N || qlen + n > MQTT_QUEUE) {
+    dropped++;
+    return 0;
+  }
+  uint8_t *p = q + qlen;
+  pkt[npkt].len = n;
+  pkt[npkt].id = id;
+  pkt[npkt].sent = 0;
+  npkt++;
+  qlen += n;
+  return p;
+}
+
+uint8_t MqttClass::publish(const char *topic, const char *payload, uint8_t len,
+                           uint8_t qos)
+{
+  uint16_t tlen = strlen(topic);
+  uint16_t rem = 2 + tlen + (qos ? 2 : 0) + len;
+  uint16_t id = 0;
+
+  if(qos) {
+    if(!++next_id)
+      next_id = 1;
+    id = next_id;
+  }
+  uint8_t *p = reserve(1 + (rem > 127 ? 2 : 1) + rem, id);
+  if(!p)
+    return 0;
+  *p++ = 0x30 | (qos << 1);
+  if(rem > 127) {
+    *p++ = (rem & 0x7F) | 0x80;
+    *p++ = rem >> 7;
+  } else {
+    *p++ = rem;
+  }
+  *p++ = tlen >> 8;
+  *p++ = tlen;
+  memcpy(p, topic, tlen);
+  p += tlen;
+  if(qos) {
+    *p++ = id >> 8;
+    *p++ = id;
+  }
+  memcpy(p, payload, len);
+  return 1;
+}
+
+// As much as the socket takes without blocking
+void MqttClass::send(void)
+{
+  uint16_t n = qlen - qsent, end = 0;
+  size_t room = client.availableForWrite();
+
+  if(n > room)
+    n = room;
+  if(n) {
+    n = client.write(q + qsent, n);
+    if(n)
+      last_tx = millis();
+    qsent += n;
+  }
+  for(uint8_t i = 0; i < npkt; i++) {
+    end += pkt[i].len;
+    if(end > qsent)
+      break;
+    if(!pkt[i].sent) {
+      pkt[i].sent = 1;
+      if((q[end - pkt[i].len] & 0xF0) == 0x30)
+        published++;
+    }
+  }
+  pop();
+}
+
+// Remove the written packets at the head, QoS 1 ones after their PUBACK
+void MqttClass::pop(void)
+{
+  uint16_t n = 0;
+  uint8_t k = 0;
+
+  while(k < npkt && pkt[k].sent && !pkt[k].id)
+    n += pkt[k++].len;
+  if(!k)
+    return;
+  memmove(q, q + n, qlen - n);
+  memmove(pkt, pkt + k, (npkt - k) * sizeof(mqtt_pkt_t));
+  npkt -= k;
+  qlen -= n;
+  qsent -= n;
+}
+
+void MqttClass::receive(void)
+{
+  int avail = client.available();
+
+  while(avail > 0 && state != MQTT_WAIT) {
+    int m = client.read(rx + rxlen, min(avail, (int)(MQTT_RX - rxlen)));
+    if(m <= 0)
+      break;
+    avail -= m;
+    rxlen += m;
+    if(rxskip) {                        // the end of a packet too large
+      uint16_t k = rxskip < rxlen ? rxskip : rxlen;
+      memmove(rx, rx + k, rxlen - k);
+      rxlen -= k;
+      rxskip -= k;
+    }
+
+    while(rxlen >= 2 && state != MQTT_WAIT) {
+      uint32_t len = 0;
+      uint8_t h = 1, shift = 0, more;
+      do {                              // remaining length
+        more = rx[h] & 0x80;
+        len |= (uint32_t)(rx[h] & 0x7F) << shift;
+        shift += 7;
+        h++;
+      } while(more && h < rxlen && h < 5);
+      if(more)
+        break;
+      if(h + len > MQTT_RX) {
+        rxskip = h + len - rxlen;
+        rxlen = 0;
+        break;
+      }
+      if(rxlen < h + len)
+        break;
+      last_rx = millis();
+      handle(rx, h, len);
+      rxlen -= h + len;
+      memmove(rx, rx + h + len, rxlen);
+    }
+  }
+}
+
+void MqttClass::handle(uint8_t *p, uint8_t h, uint16_t len)
+{
+  uint8_t *d = p + h;
+
+  switch(p[0] >> 4) {
+  case 2:                               // CONNACK
+    if(len < 2 || d[1]) {
+      lost();
+      return;
+    }
+    state = MQTT_UP;
+    backoff = MQTT_BACKOFF_MIN;
+    reconnects++;
+    {
+      uint8_t l = strlen(name);
+      uint8_t s[11 + MQTT_NAME_LEN] = {
+        0x82, (uint8_t)(9 + l),         // SUBSCRIBE
+        0, 1,
+        0, (uint8_t)(l + 4)
+      };
+      memcpy(s + 6, name, l);
+      memcpy(s + 6 + l, "/cmd", 4);
+      s[10 + l] = 0;                    // QoS 0
+      direct(s, 11 + l);
+    }
+    break;
+
+  case 3: {                             // PUBLISH
+    uint8_t qos = (p[0] >> 1) & 3;
+    uint16_t tl = (d[0] << 8) | d[1], o = 2 + tl;
+    if(o + (qos ? 2 : 0) > len)
+      return;
+    if(qos) {
+      uint8_t *a = reserve(4, 0);
+      if(a) {
+        a[0] = 0x40;                    // PUBACK
+        a[1] = 2;
+        a[2] = d[o];
+        a[3] = d[o+1];
+      }
+      o += 2;
+    }
+    uint8_t l = strlen(name);
+    if(tl == l + 4 && !memcmp(d + 2, name, l) && !memcmp(d + 2 + l, "/cmd", 4))
+      command((const char *)d + o, len - o);
+    break;
+  }
+
+  case 4: {                             // PUBACK
+    uint16_t id = (d[0] << 8) | d[1];
+    for(uint8_t i = 0; i < npkt; i++)
+      if(pkt[i].id == id && pkt[i].sent)
+        pkt[i].id = 0;
+    pop();
+    break;
+  }
+  }
+}
+
+// The message is one or more command lines, the answer goes to <name>/reply
+void MqttClass::command(const char *p, uint16_t n)
+{
+  if(!n)
+    return;
+  display.flush();
+  replying = 1;
+  TTYdata.analyze_line(&cmd, p, n, DISPLAY_MQTT);
+  if(p[n-1] != '\n' && p[n-1] != '\r')
+    TTYdata.analyze_line(&cmd, "\n", 1, DISPLAY_MQTT);
+  display.flush();
+  replying = 0;
+}
+
+// Output for DISPLAY_MQTT, published line by line
+void MqttClass::line(const char *buf, uint8_t len)
+{
+  if(state == MQTT_OFF)
+    return;
+  while(len--) {
+    char c = *buf++;
+    if(outlen < sizeof(out))
+      out[outlen++] = c;
+    if(c == '\n') {
+      report();
+      outlen = 0;
+    }
+  }
+}
+
+void MqttClass::report(void)
+{
+  char topic[MQTT_NAME_LEN + 16], *t;
+  uint8_t n = outlen;
+
+  while(n && (out[n-1] == '\n' || out[n-1] == '\r'))
+    n--;
+  if(!n)
+    return;
+  if(replying) {
+    sprintf(topic, "%s/reply", name);
+    publish(topic, out, n, 0);
+    return;
+  }
+  t = topic + sprintf(topic, "%s/%c", name, out[0]);
+  for(uint8_t i = 0; addr_tab[i].type; i++) {
+    if(addr_tab[i].type != out[0])
+      continue;
+    if(n >= addr_tab[i].off + addr_tab[i].len) {
+      *t++ = '/';
+      memcpy(t, out + addr_tab[i].off, addr_tab[i].len);
+      t += addr_tab[i].len;
+    }
+    break;
+  }
+  *t = 0;
+  publish(topic, out, n, qos());
+}
+
+#if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_MQTT)
+MqttClass Mqtt;
+#endif
@@ -0,0 +1,91 @@
+#ifndef _MQTT_H
+#define _MQTT_H
+
+#include <stdint.h>
+#include <WiFiClient.h>
+#include "board.h"
+#include "display.h"
+#include "ttydata.h"
+
+// MQTT 3.1.1 client. Every text report goes to <name>/<type>[/<address>],
+// commands published to <name>/cmd are run and answered on <name>/reply.
+// Nothing waits for the broker: the packets are queued and written as far
+// as the socket takes them, QoS 1 ones stay until their PUBACK.
+#ifndef MQTT_QUEUE
+#  define MQTT_QUEUE      1024          // outgoing packets, RAM: 1b * n
+#endif
+#define MQTT_QUEUE_N        32          // packets in the queue, RAM: 5b * n
+#define MQTT_RX            160          // largest incoming packet
+#define MQTT_KEEPALIVE      60          // s
+#define MQTT_PORT_DEFAULT 1883          // also for an erased EE_MQTT_PORT
+// connect() blocks the loop up to this long, the SlowRF edge ring holds
+// about 100ms: a broker on the LAN answers in time, the backoff retries
+#ifndef MQTT_CONNECT_MS
+#  define MQTT_CONNECT_MS   10
+#endif
+#define MQTT_CONNACK_MS   5000
+#define MQTT_BACKOFF_MIN  1000          // ms, doubled after each failure
+#define MQTT_BACKOFF_MAX 64000
+#define MQTT_NAME_LEN       21
+
+#define MQTT_OFF             0          // no broker
+#define MQTT_WAIT            1          // reconnect at retry
+#define MQTT_CONNACK         2
+#define MQTT_UP              3
+
+typedef struct {
+	uint16_t len;
+	uint16_t id;                        // QoS 1 until the PUBACK, else 0
+	uint8_t sent;
+} mqtt_pkt_t;
+
+class MqttClass {
+public:
+	MqttClass();
+	uint8_t state;
+	void func(char *in);
+	void task(void);
+	void line(const char *buf, uint8_t len);  // DISPLAY_MQTT output
+	uint16_t queued(void) { return qlen; }
+
+private:
+	WiFiClient client;
+	char name[MQTT_NAME_LEN];           // topic prefix and client id
+	uint8_t q[MQTT_QUEUE];
+	uint16_t qlen, qsent;               // bytes queued, of them written
+	mqtt_pkt_t pkt[MQTT_QUEUE_N];
+	uint8_t npkt;
+	uint8_t rx[MQTT_RX];
+	uint16_t rxlen;
+	uint32_t rxskip;                    // rest of a packet too large for rx
+	char out[DISPLAY_BUFSIZE];          // the line being collected
+	uint8_t outlen;
+	tty_line_t cmd;
+	uint8_t replying;
+	uint16_t next_id;
+	uint32_t retry, backoff, last_rx, last_tx;
+	uint32_t published, dropped, reconnects;
+
+	uint8_t broker_on(void);
+	uint16_t port(void);
+	uint8_t qos(void);
+	void connect(void);
+	void lost(void);
+	void receive(void);
+	void handle(uint8_t *p, uint8_t hlen, uint16_t len);
+	void command(const char *p, uint16_t n);
+	void send(void);
+	void pop(void);
+	void direct(const uint8_t *p, uint8_t n);
+	uint8_t *reserve(uint16_t n, uint16_t id);
+	uint8_t publish(const char *topic, const char *payload, uint8_t len,
+	                uint8_t qos);
+	void report(void);
+	void show(void);
+};
+
+#if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_MQTT)
+extern MqttClass Mqtt;
+#endif
+
+#endif
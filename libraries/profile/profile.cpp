@@ -0,0 +1,87 @@
+#include <stdlib.h>
+#include "board.h"
+#include "display.h"
+#include "ttydata.h"
+#include "profile.h"
+
+static const char task_name[PROF_TASKS][8] = {
+  "loop", "clock", "serial", "analyze", "send", "minute", "fastrf",
+  "router", "asksin", "ir", "tcp", "moritz", "rwe", "native", "kopp",
+  "mbus", "zwave", "evohome", "flush", "mqtt", "fht"
+};
+
+void ProfileClass::clear(void)
+{
+  for(uint8_t i = 0; i < PROF_TASKS + ncmd; i++)
+    hist[i].clear();
+  loop_start = 0;
+}
+
+// Called by Sched.run() at the start of every pass
+void ProfileClass::loop(void)
+{
+  if(!hist)
+    return;
+  uint32_t now = micros();
+  if(loop_start)
+    hist[PROF_LOOP].add(now - loop_start);
+  loop_start = now;
+}
+
+// p1: start, p0: stop and free the memory, p: report, pr: report and clear.
+// Times of the tasks which call commands (serial, tcp) include them.
+void ProfileClass::func(char *in)
+{
+  if(in[1] == '1') {
+    if(!hist) {
+      for(ncmd = 0; fntab[ncmd].name; ncmd++)
+        ;
+      hist = (Histogram *)malloc((PROF_TASKS + ncmd) * sizeof(Histogram));
+      if(!hist) {
+        DS("no memory");
+        DNL();
+        return;
+      }
+      clear();
+    }
+    return;
+  }
+  if(in[1] == '0') {
+    free(hist);
+    hist = 0;
+    return;
+  }
+  if(!hist) {
+    DS("off");
+    DNL();
+    return;
+  }
+
+  Histogram *l = &hist[PROF_LOOP];
+  DS("loop/s:");
+  DU(l->sum ? (uint32_t)(l->n * 1000000ull / l->sum) : 0, 0);
+  DNL();
+  for(uint8_t i = 0; i < PROF_TASKS + ncmd; i++) {
+    Histogram *h = &hist[i];
+    if(!h->n)
+      continue;
+    if(i < PROF_TASKS) {
+      DS((char *)task_name[i]);
+    } else {
+      DS("cmd ");
+      DC(fntab[i - PROF_TASKS].name);
+    }
+    DC(' ');
+    h->print(0);
+    DS(" total:");
+    DU((uint32_t)(h->sum / 1000), 0);
+    DS("ms");
+    DNL();
+  }
+  if(in[1] == 'r')
+    clear();
+}
+
+#if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_PROFILE)
+ProfileClass Profile;
+#endif
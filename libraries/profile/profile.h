@@ -0,0 +1,53 @@
+#ifndef _PROFILE_H
+#define _PROFILE_H
+
+#include <Arduino.h>
+#include "histogram.h"
+
+// p: run time of the main loop tasks and of the commands, the ids of the
+// tasks are given to Sched.add()
+#define PROF_LOOP      0                // one loop iteration
+#define PROF_CLOCK     1                // CLOCK.IsrHandler, 125Hz
+#define PROF_SERIAL    2
+#define PROF_ANALYZE   3
+#define PROF_SEND      4
+#define PROF_MINUTE    5
+#define PROF_FASTRF    6
+#define PROF_ROUTER    7
+#define PROF_ASKSIN    8
+#define PROF_IR        9
+#define PROF_ETHERNET 10
+#define PROF_MORITZ   11
+#define PROF_RWE      12
+#define PROF_NATIVE   13
+#define PROF_KOPP     14
+#define PROF_MBUS     15
+#define PROF_ZWAVE    16
+#define PROF_EVOHOME  17
+#define PROF_FLUSH    18
+#define PROF_MQTT     19
+#define PROF_FHT      20
+#define PROF_TASKS    21                // fntab commands follow
+
+class ProfileClass {
+public:
+	void func(char *in);
+	void loop(void);
+	void task(uint8_t id, uint32_t start) {
+	  if(hist)
+	    hist[id].add(micros() - start);
+	}
+	void command(uint8_t idx, uint32_t start) { task(PROF_TASKS + idx, start); }
+
+private:
+	Histogram *hist;                // PROF_TASKS + fntab entries, 0: off
+	uint8_t ncmd;
+	uint32_t loop_start;
+	void clear(void);
+};
+
+#if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_PROFILE)
+extern ProfileClass Profile;
+#endif
+
+#endif
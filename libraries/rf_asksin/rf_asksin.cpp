@@ -9,6 +9,10 @@
 #include "stringfunc.h"
 #include "cc1101_pllcheck.h"
 #include "clock.h"
+#include "rf_pktq.h"
+#ifdef HAS_RF_FRAME
+#  include "rf_frame.h"
+#endif
 
 #include "rf_asksin.h"
 
@@ -88,7 +92,7 @@ RfAsksinClass::init(void)
   } while (CC1100.cc1100_readReg(CC1100_MARCSTATE) != MARCSTATE_RX);
 }
 
-void
+void ICACHE_RAM_ATTR
 RfAsksinClass::reset_rx(void)
 {
   CC1100.ccStrobe( CC1100_SFRX  );
@@ -97,42 +101,58 @@ RfAsksinClass::reset_rx(void)
   CC1100.ccStrobe( CC1100_SRX   );
 }
 
+// Move a CRC OK packet (GDO2 high) from the FIFO to RfPktq, called by the
+// GDO2 ISR, or by task() if the SPI was in use.
+void ICACHE_RAM_ATTR
+RfAsksinClass::read(void)
+{
+  rf_pkt_t *p = RfPktq.slot();
+  if (!p)
+    return;
+
+  p->us = micros();                  // XT: read, not the sync time
+  p->len = CC1100.cc1100_readReg( CC1100_RXFIFO ) & 0x7f; // read len
+
+  if (p->len >= MAX_ASKSIN_MSG) {
+    // Something went horribly wrong, out of sync?
+    reset_rx();
+    return;
+  }
+
+  RfPktq.burst(p->data, p->len+2);   // + rssi, lqi
+  p->rssi = p->data[p->len];
+  p->lqi = p->data[p->len+1];
+
+  CC1100.ccStrobe(CC1100_SRX);       // no waiting here, task() checks MARCSTATE
+  RfPktq.put();
+}
+
 void
 RfAsksinClass::task(void)
 {
   uint8_t msg[MAX_ASKSIN_MSG];
   uint8_t this_enc, last_enc;
-  uint8_t rssi;
+  uint8_t rssi, lqi;
   uint8_t l;
+  rf_pkt_t *p;
 
   if(!on)
     return;
 
-  // see if a CRC OK pkt has been arrived
+  // see if a CRC OK pkt has been arrived, and not read by the ISR
   if (bit_is_set( CC1100_IN_PORT, CC1100_IN_PIN )) {
-    msg[0] = CC1100.cc1100_readReg( CC1100_RXFIFO ) & 0x7f; // read len
-
-    if (msg[0] >= MAX_ASKSIN_MSG) {
-      // Something went horribly wrong, out of sync?
-      reset_rx();
-      return;
-    }
-
-    CC1100_ASSERT;
-    CC1100.cc1100_sendbyte( CC1100_READ_BURST | CC1100_RXFIFO );
-    
-    for (uint8_t i=0; i<msg[0]; i++) {
-         msg[i+1] = CC1100.cc1100_sendbyte( 0 );
-    }
-    
-    rssi = CC1100.cc1100_sendbyte( 0 );
-    /* LQI = */ CC1100.cc1100_sendbyte( 0 );
+    CC1100.spi_busy++;
+    read();
+    CC1100.spi_busy--;
+  }
 
-    CC1100_DEASSERT;
-
-    do {
-      CC1100.ccStrobe(CC1100_SRX);
-    } while (CC1100.cc1100_readReg(CC1100_MARCSTATE) != MARCSTATE_RX);
+  while ((p = RfPktq.get())) {
+    uint32_t us = p->us;
+    msg[0] = p->len;
+    memcpy(msg+1, p->data, p->len);
+    rssi = p->rssi;
+    lqi = p->lqi;
+    RfPktq.drop();
 
     last_enc = msg[1];
     msg[1] = (~msg[1]) ^ 0x89;
@@ -145,6 +165,11 @@ RfAsksinClass::task(void)
     
     msg[l] = msg[l] ^ msg[2];
     
+#ifdef HAS_RF_FRAME
+    if (RfFrame.mode == FRAME_BINARY) {
+      RfFrame.send('A', msg, msg[0]+1, FRAME_RSSI|FRAME_LQI, rssi, lqi, us);
+    } else
+#endif
     if (tx_report & REP_BINTIME) {
       
       DC('a');
@@ -154,11 +179,12 @@ RfAsksinClass::task(void)
     } else {
       DC('A');
       
-      for (uint8_t i=0; i<=msg[0]; i++)
-        DH2( msg[i] );
+      display.hexbuf(msg, msg[0]+1);
       
       if (tx_report & REP_RSSI)
         DH2(rssi);
+      if (RfReceive.stamp)
+        RfReceive.stamp_display(us);
       
       DNL();
     }
@@ -194,6 +220,8 @@ RfAsksinClass::send(char *in)
     return;
   }
 
+  RfSend.tx_wait();
+
   // in AskSin mode already?
   if(!on) {
     init();
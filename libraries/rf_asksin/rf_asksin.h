@@ -15,6 +15,7 @@ public:
 
   void init(void);
   void task(void);
+  void read(void);
   void func(char *in);
 private:
   static void reset_rx(void);
@@ -0,0 +1,73 @@
+#include <string.h>
+#include "board.h"
+#include "display.h"
+#include "fncollection.h"
+#include "stringfunc.h"
+#include "clock.h"
+#include "rf_receive.h"
+#include "rf_frame.h"
+
+void RfFrameClass::init(void)
+{
+  mode = FNcol.erb(EE_RF_FRAME);
+}
+
+// XW: report, XW<nn>: set and save the report format, 00 text, 01 binary
+void RfFrameClass::func(char *in)
+{
+  uint8_t m;
+
+  if(STRINGFUNC.fromhex(in+2, &m, 1)) {
+    mode = m;
+    FNcol.ewb(EE_RF_FRAME, mode);
+  }
+  DH2(mode);
+  DNL();
+}
+
+void RfFrameClass::put(uint8_t c)
+{
+  crc_out = rf_frame_crc16(crc_out, c);
+  DC(c);
+}
+
+// us: micros() at the reception, reported with XT01
+void RfFrameClass::send(uint8_t type, const uint8_t *data, uint8_t len,
+                        uint8_t flags, uint8_t rssi, uint8_t lqi, uint32_t us)
+{
+  uint64_t t = millis();
+  uint8_t tlen = 4;
+
+  if(RfReceive.stamp) {
+    t = CLOCK.stamp_us(us);
+    tlen = 8;
+    flags |= FRAME_STAMP;
+  }
+
+  display.flush();                     // a pending text line still goes
+  uint8_t ch = display.channel;        // to MQTT, the frame does not
+  display.channel &= ~DISPLAY_MQTT;
+
+  crc_out = 0xFFFF;
+  DC(FRAME_SYNC);
+  put(type);
+  put(flags);
+  put(len);
+  for(uint8_t i = 0; i < len; i++)
+    put(data[i]);
+  if(flags & FRAME_RSSI)
+    put(rssi);
+  if(flags & FRAME_LQI)
+    put(lqi);
+  for(uint8_t i = 0; i < tlen; i++, t >>= 8)
+    put(t);
+  uint16_t c = crc_out;
+  DC(c);
+  DC(c >> 8);
+  display.flush();                     // frames are not lines
+  display.channel = ch;
+}
+
+#if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_RF_FRAME)
+RfFrameClass RfFrame;
+#endif
@@ -0,0 +1,68 @@
+#ifndef _RF_FRAME_H
+#define _RF_FRAME_H
+
+#include <stdint.h>
+
+// XW01: received messages are reported as binary frames instead of hex lines
+//   A5 type flags len data[len] [rssi] [lqi] time[4|8] crc[2]
+// type is the letter of the text report (F, T, A, Z, N...), rssi and lqi
+// are only present if flagged. time is millis() at the report, with XT01
+// the reception time in us as for CLOCK.stamp_us. The CRC is CRC-16/CCITT
+// (0x1021, start 0xFFFF) from type to time. Multibyte values are little
+// endian.
+#define FRAME_SYNC       0xA5
+#define FRAME_MAXDATA     255
+#define FRAME_OVERHEAD     16           // sync...crc with everything
+
+#define FRAME_NIBBLE     0x01           // only the low nibble of the last
+                                        // data byte is valid
+#define FRAME_RSSI       0x02           // rssi is valid
+#define FRAME_LQI        0x04           // lqi is valid
+#define FRAME_STAMP      0x08           // time is the 8 byte reception time
+
+#define FRAME_TEXT          0           // XW modes
+#define FRAME_BINARY        1
+
+typedef struct {
+  uint8_t type, flags, len;
+  uint8_t data[FRAME_MAXDATA];
+  uint8_t rssi, lqi;
+  uint64_t time;                        // ms, or us with FRAME_STAMP
+} rf_frame_t;
+
+uint16_t rf_frame_crc16(uint16_t crc, uint8_t c);
+
+class RfFrameClass {
+public:
+	uint8_t mode;                         // XW
+
+	void init(void);
+	void func(char *in);
+	void send(uint8_t type, const uint8_t *data, uint8_t len, uint8_t flags,
+	          uint8_t rssi, uint8_t lqi, uint32_t us);
+
+private:
+	uint16_t crc_out;
+	void put(uint8_t c);
+};
+
+// For the receiving side, rf_frame_parse.cpp has no firmware dependencies:
+// feed every byte, a complete frame with a valid CRC returns 1 and is in
+// frame.
+class RfFrameParser {
+public:
+	RfFrameParser();
+	rf_frame_t frame;
+	uint32_t crc_errors;
+	uint8_t parse(uint8_t c);
+
+private:
+	uint8_t raw[FRAME_MAXDATA+FRAME_OVERHEAD-1];  // frame without the sync
+	uint16_t pos;                         // 0: waiting for the sync
+};
+
+#if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_RF_FRAME)
+extern RfFrameClass RfFrame;
+#endif
+
+#endif
@@ -0,0 +1,59 @@
+#include <string.h>
+#include "rf_frame.h"
+
+uint16_t rf_frame_crc16(uint16_t crc, uint8_t c)
+{
+  crc ^= (uint16_t)c << 8;
+  for(uint8_t i = 0; i < 8; i++)
+    crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  return crc;
+}
+
+RfFrameParser::RfFrameParser()
+{
+  pos = 0;
+  crc_errors = 0;
+}
+
+uint8_t RfFrameParser::parse(uint8_t c)
+{
+  if(pos == 0) {
+    if(c == FRAME_SYNC)
+      pos = 1;
+    return 0;
+  }
+
+  raw[pos-1] = c;
+  pos++;
+  if(pos < 4)
+    return 0;
+
+  uint8_t *p = raw+3+raw[2];            // behind the data
+  uint16_t n = p-raw+((raw[1] & FRAME_STAMP) ? 10 : 6);  // + time and crc
+  if(raw[1] & FRAME_RSSI)
+    n++;
+  if(raw[1] & FRAME_LQI)
+    n++;
+  if(pos-1 < n)
+    return 0;
+  pos = 0;
+
+  uint16_t crc = 0xFFFF;
+  for(uint16_t i = 0; i < n-2; i++)
+    crc = rf_frame_crc16(crc, raw[i]);
+  if(crc != (raw[n-2] | (uint16_t)raw[n-1] << 8)) {
+    crc_errors++;
+    return 0;
+  }
+
+  frame.type  = raw[0];
+  frame.flags = raw[1];
+  frame.len   = raw[2];
+  memcpy(frame.data, raw+3, frame.len);
+  frame.rssi  = (frame.flags & FRAME_RSSI) ? *p++ : 0;
+  frame.lqi   = (frame.flags & FRAME_LQI)  ? *p++ : 0;
+  frame.time  = 0;
+  for(uint8_t i = (frame.flags & FRAME_STAMP) ? 8 : 4; i > 0; i--)
+    frame.time = frame.time << 8 | p[i-1];
+  return 1;
+}
@@ -0,0 +1,369 @@
+/*
+ * Copyright by D.Tostmann
+ * Inspired by code from TI.com AN
+ * License: GPL v2
+ */
+
+#include "board.h"
+#ifdef HAS_MBUS
+#include "cc1100.h"
+#include "delay.h"
+#include "rf_receive.h"
+#include "display.h"
+#include "rf_pktq.h"
+#ifdef HAS_RF_FRAME
+#  include "rf_frame.h"
+#endif
+
+#include "rf_mbus.h"
+#include "smode_rf_settings.h"
+#include "tmode_rf_settings.h"
+#include "mbus_packet.h"
+#include "manchester.h"
+#include "3outof6.h"
+
+// (Re)start RX, waiting for the first 4 bytes after the sync word
+void ICACHE_RAM_ATTR RfMbusClass::listen(void)
+{
+  state = MBUS_RX_OFF;
+  CC1100.ccStrobe( CC1100_SIDLE );
+  CC1100.ccStrobe( CC1100_SFRX );
+  CC1100.cc1100_writeReg( CC1100_FIFOTHR, MBUS_FIFOTHR_LEN );
+  CC1100.cc1100_writeReg( CC1100_PKTCTRL0, format = MBUS_PKT_INFINITE );
+  CC1100.cc1100_writeReg( CC1100_IOCFG2, gdo = MBUS_GDO_FIFO );
+  CC1100.ccStrobe( CC1100_SRX );
+  started = millis();
+  state = MBUS_RX_LEN;
+}
+
+void RfMbusClass::init(uint8_t m)
+{
+  mode = WMBUS_NONE;                    // the ISR keeps off
+  state = MBUS_RX_OFF;
+  CC1100.manualReset();                 // RfZwave off as well
+
+  switch (m) {
+  case WMBUS_SMODE:
+    for (uint8_t i = 0; i < 200; i += 2) {
+      if (sCFG(i) > 0x40)
+        break;
+      CC1100.cc1100_writeReg( sCFG(i), sCFG(i+1) );
+    }
+    break;
+  // T-mode settings work for C-mode, which allows receiving
+  // both T-mode and C-mode frames simultaneously. See SWRA522D.
+  case WMBUS_TMODE:
+  case WMBUS_CMODE:
+    for (uint8_t i = 0; i < 200; i += 2) {
+      if (tCFG(i) > 0x40)
+        break;
+      CC1100.cc1100_writeReg( tCFG(i), tCFG(i+1) );
+    }
+    break;
+  default:
+    return;
+  }
+
+  CC1100.ccStrobe( CC1100_SCAL );
+  MYDELAY.my_delay_ms(4);
+  CC1100.ccRX();                        // GDO2 interrupt on
+
+  CC1100.spi_busy++;
+  mode = m;
+  listen();
+  CC1100.spi_busy--;
+}
+
+// L-field and the wM-Bus packet size with CRCs for the ISR, which only
+// reaches IRAM code (CC1100, RfPktq, these). decodeRXBytes*() and
+// packetSize() in mbus_packet.cpp are not, task() decodes with them.
+static uint16_t ICACHE_RAM_ATTR
+lfield_smode(const uint8_t *d)
+{
+  uint8_t d3 = manchDecodeTab[d[0] >> 4], d2 = manchDecodeTab[d[0] & 0x0F];
+  uint8_t d1 = manchDecodeTab[d[1] >> 4], d0 = manchDecodeTab[d[1] & 0x0F];
+
+  if ((d3 | d2 | d1 | d0) & 0xFC)
+    return 0xFFFF;
+  return (d3 << 6) | (d2 << 4) | (d1 << 2) | d0;
+}
+
+static uint16_t ICACHE_RAM_ATTR
+lfield_tmode(const uint8_t *d)
+{
+  uint8_t d1 = decodeTab3outof6[d[0] >> 2];
+  uint8_t d0 = decodeTab3outof6[((d[0] & 0x03) << 4) | (d[1] >> 4)];
+
+  if ((d1 | d0) & 0xF0)
+    return 0xFFFF;
+  return (d1 << 4) | d0;
+}
+
+static uint16_t ICACHE_RAM_ATTR
+packet_size(uint8_t l)
+{
+  return l + 1 + 2 * (l < 26 ? 2 : (l - 26)/16 + 3);
+}
+
+// Got the first 3 bytes: the L-field tells how many follow. 0: not a
+// telegram we can take.
+uint8_t ICACHE_RAM_ATTR RfMbusClass::length(mbus_rx_t *t)
+{
+  uint16_t l;
+
+  RfPktq.burst(t->data, 3);
+  t->us = micros();
+  started = millis();
+
+  if (mode == WMBUS_SMODE) {
+    if ((l = lfield_smode(t->data)) > 0xFF)
+      return 0;
+    t->framemode = WMBUS_SMODE;
+    t->frametype = WMBUS_FRAMEA;
+    t->lfield = l;
+    t->len = 2 * packet_size(l);        // Manchester
+
+  // In C-mode T-mode frames are received as well: after the T-mode sync
+  // the first byte is either valid 3 out of 6 or the C-mode 0x54 (SWRA522D)
+  } else if (mode == WMBUS_CMODE && t->data[0] == 0x54) {
+    t->framemode = WMBUS_CMODE;
+    t->lfield = t->data[2];
+    if (t->data[1] == 0xCD) {
+      if (t->lfield < 9)
+        return 0;
+      t->frametype = WMBUS_FRAMEA;
+      t->len = 2 + packet_size(t->lfield);
+    } else if (t->data[1] == 0x3D) {
+      if (t->lfield < 12 || t->lfield == 128)
+        return 0;
+      t->frametype = WMBUS_FRAMEB;
+      t->len = 2 + 1 + t->lfield;       // the L-field counts the CRCs
+    } else
+      return 0;
+
+  } else {
+    if ((l = lfield_tmode(t->data)) > 0xFF)
+      return 0;
+    t->framemode = WMBUS_TMODE;
+    t->frametype = WMBUS_FRAMEA;
+    t->lfield = l;
+    t->len = (3 * packet_size(l) + 1) / 2; // 3 out of 6, and the postamble
+  }
+
+  if (t->len > MBUS_BYTES)
+    return 0;
+
+  // Fixed length up to 255 bytes, else infinite until less than 256 are
+  // left, with PKTLEN the rest modulo 256
+  CC1100.cc1100_writeReg( CC1100_PKTLEN, (uint8_t)t->len );
+  if (t->len < MBUS_FIXED_MAX)
+    CC1100.cc1100_writeReg( CC1100_PKTCTRL0, format = MBUS_PKT_FIXED );
+  CC1100.cc1100_writeReg( CC1100_FIFOTHR, MBUS_FIFOTHR_DATA );
+  left = t->len - 3;
+  if (left + 2 < MBUS_FIFO_CHUNK)
+    CC1100.cc1100_writeReg( CC1100_IOCFG2, gdo = MBUS_GDO_END );
+  return 1;
+}
+
+// More of the telegram is in the FIFO: 0 to wait for the next chunk, 1
+// when it is complete, 2 when the FIFO overflowed.
+uint8_t ICACHE_RAM_ATTR RfMbusClass::data(mbus_rx_t *t)
+{
+  uint8_t n = RfPktq.status( CC1100_RXBYTES );
+  uint8_t *p = t->data + t->len - left;
+
+  if (n & 0x80)
+    return 2;
+
+  if (gdo == MBUS_GDO_END) {
+    if (n < left + 2)
+      return 0;
+    RfPktq.burst(p, left);
+    RfPktq.burst(&t->rssi, 2);          // appended: RSSI, LQI
+    left = 0;
+    return 1;
+  }
+
+  // Leave a byte in the FIFO while receiving (CC1101 errata)
+  if (n < 2)
+    return 0;
+  if (--n > left)
+    n = left;
+  RfPktq.burst(p, n);
+  left -= n;
+
+  if (format == MBUS_PKT_INFINITE && left < MBUS_FIXED_MAX)
+    CC1100.cc1100_writeReg( CC1100_PKTCTRL0, format = MBUS_PKT_FIXED );
+
+  // The rest with RSSI and LQI stays below the threshold: wait for the
+  // end of the packet. GDO2 then stays high until the FIFO is empty, the
+  // tail is polled by task().
+  if (left + 2 < MBUS_FIFO_CHUNK)
+    CC1100.cc1100_writeReg( CC1100_IOCFG2, gdo = MBUS_GDO_END );
+  return 0;
+}
+
+// GDO2 high: the L-field, the next chunk or the end of the telegram is in
+// the FIFO. Called by the GDO2 ISR, or by task() if the SPI was in use.
+void ICACHE_RAM_ATTR RfMbusClass::read(void)
+{
+  mbus_rx_t *t = &q[in & (MBUS_QUEUE-1)];
+  uint8_t r;
+
+  // GDO2 stays high if more than one step is waiting
+  for (uint8_t i = 4; i && bit_is_set( CC1100_IN_PORT, CC1100_IN_PIN ); i--) {
+    if (state == MBUS_RX_LEN) {
+      if ((uint8_t)(in - out) >= MBUS_QUEUE) {
+        stat_full++;
+        listen();
+        return;
+      }
+      if (!length(t)) {
+        listen();
+        return;
+      }
+      state = MBUS_RX_DATA;
+
+    } else if (state == MBUS_RX_DATA) {
+      if ((r = data(t))) {
+        if (r == 1)
+          in++;
+        else
+          stat_lost++;
+        listen();
+        return;
+      }
+
+    } else
+      return;
+  }
+}
+
+void RfMbusClass::report(mbus_rx_t *t)
+{
+  uint16_t n, st;
+
+  if (t->framemode == WMBUS_SMODE) {
+    n = packetSize(t->lfield);
+    st = decodeRXBytesSmode(t->data, packet, n);
+  } else if (t->framemode == WMBUS_TMODE) {
+    n = packetSize(t->lfield);
+    st = decodeRXBytesTmode(t->data, packet, n);
+  } else if (t->frametype == WMBUS_FRAMEA) {
+    n = packetSize(t->lfield);
+    st = verifyCrcBytesCmodeA(t->data + 2, packet, n);
+  } else {
+    n = t->lfield + 1;
+    st = verifyCrcBytesCmodeB(t->data + 2, packet, n);
+  }
+
+  if (st == PACKET_CODING_ERROR) {
+    stat_coding++;
+    return;
+  }
+  if (st != PACKET_OK) {
+    stat_crc++;
+    return;
+  }
+  stat_ok++;
+
+#ifdef HAS_RF_FRAME
+  if (RfFrame.mode == FRAME_BINARY && n <= FRAME_MAXDATA) {
+    RfFrame.send(t->frametype == WMBUS_FRAMEB ? 'Y' : 'b', packet, n,
+                 FRAME_RSSI|FRAME_LQI, t->rssi, t->lqi, t->us);
+    return;
+  }
+#endif
+
+  DC('b');
+  if (t->frametype == WMBUS_FRAMEB)
+    DC('Y');                            // C-mode frame format B
+  for (uint16_t i = 0; i < n; i += 128)
+    display.hexbuf(packet + i, n - i < 128 ? n - i : 128);
+  if (tx_report & REP_RSSI) {
+    DH2(t->lqi);
+    DH2(t->rssi);
+  }
+  if (RfReceive.stamp)
+    RfReceive.stamp_display(t->us);
+  DNL();
+}
+
+void RfMbusClass::task(void)
+{
+  if (!on())
+    return;
+
+  // GDO2 high, and not read by the ISR
+  if (bit_is_set( CC1100_IN_PORT, CC1100_IN_PIN )) {
+    CC1100.spi_busy++;
+    read();
+    CC1100.spi_busy--;
+  }
+
+  if (in != out) {                      // one telegram per call
+    report(&q[out & (MBUS_QUEUE-1)]);
+    out++;
+    return;
+  }
+
+  // Now and then: restart a telegram which did not end, or a receiver
+  // which is not in RX (FIFO overflow while waiting for the L-field)
+  if ((uint32_t)(millis() - started) < MBUS_RX_TIMEOUT)
+    return;
+  CC1100.spi_busy++;
+  if (state == MBUS_RX_DATA) {
+    stat_lost++;
+    listen();
+  } else if (RfPktq.status( CC1100_MARCSTATE ) != MARCSTATE_RX)
+    listen();
+  else
+    started = millis();
+  CC1100.spi_busy--;
+}
+
+void RfMbusClass::status(void)
+{
+  switch (mode) {
+  case WMBUS_SMODE: DS("SMODE"); break;
+  case WMBUS_TMODE: DS("TMODE"); break;
+  case WMBUS_CMODE: DS("CMODE"); break;
+  default:          DS("OFF");
+  }
+  DNL();
+}
+
+// br<s|t|c>: receive S1, T1 or C1 (and T1), brx: off, bS: statistics,
+// b: the mode
+void RfMbusClass::func(char *in)
+{
+  if (in[1] == 'r' && in[2]) {
+    switch (in[2]) {
+    case 's': init(WMBUS_SMODE); break;
+    case 't': init(WMBUS_TMODE); break;
+    case 'c': init(WMBUS_CMODE); break;
+    default:  init(WMBUS_NONE);
+    }
+
+  } else if (in[1] == 's') {            // send, not ported
+    DS("not compiled in\r\n");
+    return;
+
+  } else if (in[1] == 'S') {
+    DS("ok:");      DU(stat_ok, 0);
+    DS(" crc:");    DU(stat_crc, 0);
+    DS(" coding:"); DU(stat_coding, 0);
+    DS(" full:");   DU(stat_full, 0);
+    DS(" lost:");   DU(stat_lost, 0);
+    DNL();
+    return;
+  }
+
+  status();
+}
+
+#if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_RF_MBUS)
+RfMbusClass RfMbus;
+#endif
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef _RF_MBUS_H
+#define _RF_MBUS_H
+
+#include <Arduino.h>
+#include "mbus_defs.h"
+
+// Wireless M-Bus reception (S1, T1, C1), see clib/rf_mbus.c for the AVR
+// original. The GDO2 ISR moves the telegram from the RX FIFO into a queue
+// slot as it arrives, the task decodes it and reports b<hex> / bY<hex>.
+#define MBUS_QUEUE        2             // telegrams, power of 2
+#define MBUS_BYTES      584             // encoded, RAM: 600b * MBUS_QUEUE
+#define MBUS_PACKET     291             // decoded
+#define MBUS_RX_TIMEOUT 200             // ms, longer than any telegram
+
+#define	WMBUS_NONE        0
+
+// GDO2: RX FIFO at or above FIFOTHR, or at the end of the packet
+#define MBUS_GDO_FIFO     0x00
+#define MBUS_GDO_END      0x01
+#define MBUS_FIFOTHR_LEN  0x00          // 4 bytes: L-field
+#define MBUS_FIFOTHR_DATA 0x07          // 32 bytes
+#define MBUS_FIFO_CHUNK   32
+#define MBUS_PKT_FIXED    0x00          // PKTCTRL0
+#define MBUS_PKT_INFINITE 0x02
+#define MBUS_FIXED_MAX    256           // PKTLEN limit
+
+#define MBUS_RX_OFF       0
+#define MBUS_RX_LEN       1             // waiting for the L-field
+#define MBUS_RX_DATA      2
+
+typedef struct {
+	uint32_t us;                        // micros() at the L-field, XT
+	uint16_t len;                       // encoded bytes
+	uint8_t lfield;
+	uint8_t framemode, frametype;       // WMBUS_*
+	uint8_t rssi, lqi;
+	uint8_t data[MBUS_BYTES];
+} mbus_rx_t;
+
+class RfMbusClass {
+public:
+	uint8_t mode;                       // WMBUS_NONE, _SMODE, _TMODE, _CMODE
+
+	uint8_t on(void) { return mode != WMBUS_NONE; }
+	void off(void) { mode = WMBUS_NONE; } // the config was overwritten
+	void read(void);                    // GDO2 ISR
+	void task(void);
+	void func(char *in);
+	uint8_t pending(void) { return in != out; }
+
+private:
+	mbus_rx_t q[MBUS_QUEUE];
+	volatile uint8_t in, out;
+	volatile uint8_t state;             // MBUS_RX_*
+	uint16_t left;                      // bytes still to read
+	uint8_t format;                     // PKTCTRL0, MBUS_PKT_*
+	uint8_t gdo;                        // IOCFG2, MBUS_GDO_*
+	uint32_t started;                   // millis() at listen() or the L-field
+	uint8_t packet[MBUS_PACKET];
+	uint16_t stat_ok, stat_crc, stat_coding, stat_full, stat_lost;
+
+	void init(uint8_t m);
+	void listen(void);
+	uint8_t length(mbus_rx_t *t);
+	uint8_t data(mbus_rx_t *t);
+	void report(mbus_rx_t *t);
+	void status(void);
+};
+
+#if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_RF_MBUS)
+extern RfMbusClass RfMbus;
+#endif
+
+#endif
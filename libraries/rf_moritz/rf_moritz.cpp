@@ -13,6 +13,10 @@
 #include "display.h"
 #include "clock.h"
 #include "rf_send.h" //credit_10ms
+#include "rf_pktq.h"
+#ifdef HAS_RF_FRAME
+#  include "rf_frame.h"
+#endif
 
 #include "rf_moritz.h"
 
@@ -117,12 +121,10 @@ void RfMoritzClass::init(void)
 	// not in c <--
   
 	// load configuration
-  CC1100_ASSERT;                             
-  CC1100.cc1100_sendbyte( 0 | CC1100_WRITE_BURST );
-  for(uint8_t i = 0; i < 0x29; i++) {
-	  CC1100.cc1100_sendbyte(pgm_read_byte(&MORITZ_CFG[i]));
-  }
-  CC1100_DEASSERT;
+  uint8_t cfg[0x29];
+  for(uint8_t i = 0; i < 0x29; i++)
+	  cfg[i] = pgm_read_byte(&MORITZ_CFG[i]);
+  CC1100.cc1100_writeRegs(0, cfg, 0x29);
 
   //auto? CC1100.ccStrobe( CC1100_SCAL );
   //auto? MYDELAY.my_delay_ms(4); // 4ms: Found by trial and error
@@ -176,38 +178,58 @@ void RfMoritzClass::handleAutoAck(uint8_t* enc)
   return;
 }
 
+// Move a CRC OK packet (GDO2 high) from the FIFO to RfPktq, called by the
+// GDO2 ISR, or by task() if the SPI was in use.
+void ICACHE_RAM_ATTR RfMoritzClass::read(void)
+{
+  rf_pkt_t *p = RfPktq.slot();
+  if(!p)
+    return;
+
+  p->us = micros();                  // XT: read, not the sync time
+  //errata #1 does not affect us, because we wait until packet is completely received
+  p->len = CC1100.cc1100_readReg( CC1100_RXFIFO ) & 0x7f; // read len
+
+  if (p->len>=MAX_MORITZ_MSG)
+       p->len = MAX_MORITZ_MSG-1;
+
+  // RSSI and Link quality indicator are appended to RXFIFO
+  RfPktq.burst(p->data, p->len+2);
+  p->rssi = p->data[p->len];
+  p->lqi = p->data[p->len+1];
+  RfPktq.put();
+}
+
 void RfMoritzClass::task(void)
 {
   uint8_t enc[MAX_MORITZ_MSG];
   uint8_t rssi, LQI;
+  rf_pkt_t *p;
 
   if(!onState)
     return;
-  // see if a CRC OK pkt has been arrived (GDO2 high)
+  // see if a CRC OK pkt has been arrived (GDO2 high), and not read by the ISR
   if(bit_is_set( CC1100_IN_PORT, CC1100_IN_PIN )) {
-    //errata #1 does not affect us, because we wait until packet is completely received
-    enc[0] = CC1100.cc1100_readReg( CC1100_RXFIFO ) & 0x7f; // read len
-
-    if (enc[0]>=MAX_MORITZ_MSG)
-         enc[0] = MAX_MORITZ_MSG-1;
-
-    CC1100_ASSERT;
-    CC1100.cc1100_sendbyte( CC1100_READ_BURST | CC1100_RXFIFO );
-
-    for (uint8_t i=0; i<enc[0]; i++) {
-         enc[i+1] = CC1100.cc1100_sendbyte( 0 );
-    }
-
-    // RSSI is appended to RXFIFO
-    rssi = CC1100.cc1100_sendbyte( 0 );
-
-    // And Link quality indicator, too
-    LQI = CC1100.cc1100_sendbyte( 0 );
+    CC1100.spi_busy++;
+    read();
+    CC1100.spi_busy--;
+  }
 
-    CC1100_DEASSERT;
+  if((p = RfPktq.get())) {
+    uint32_t us = p->us;
+    enc[0] = p->len;
+    memcpy(enc+1, p->data, p->len);
+    rssi = p->rssi;
+    LQI = p->lqi;
+    RfPktq.drop();
 
     handleAutoAck(enc);
 
+#ifdef HAS_RF_FRAME
+    if (RfFrame.mode == FRAME_BINARY) {
+      RfFrame.send('Z', enc, enc[0]+1, FRAME_RSSI|FRAME_LQI, rssi, LQI, us);
+    } else
+#endif
     if (tx_report & REP_BINTIME) {
 
       DC('z');
@@ -215,13 +237,14 @@ void RfMoritzClass::task(void)
       DC( enc[i] );
     } else {
       DC('Z');
-      for (uint8_t i=0; i<=enc[0]; i++)
-        DH2( enc[i] );
+      display.hexbuf(enc, enc[0]+1);
       if (tx_report & REP_RSSI)
 			{
         DH2(rssi);
         //DH2(LQI);
 			}
+      if (RfReceive.stamp)
+        RfReceive.stamp_display(us);
       DNL();
     }
 
@@ -266,6 +289,7 @@ void RfMoritzClass::sendraw(uint8_t *dec, int longPreamble)
     return;
   }
   RfSend.credit_10ms -= sum;
+  RfSend.tx_wait();
 
   // in Moritz mode already?
   if(!onState) {
@@ -419,8 +443,7 @@ void RfMoritzClass::sendAck(uint8_t* enc)
 
   //Inform FHEM that we send an autoack
   DC('Z');
-  for (uint8_t i=0; i < ackPacket[0]+1; i++)
-    DH2( ackPacket[i] );
+  display.hexbuf(ackPacket, ackPacket[0]+1);
   if (tx_report & REP_RSSI)
     DH2( 0 ); //fake some rssi
   DNL();
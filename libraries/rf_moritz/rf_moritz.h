@@ -10,10 +10,12 @@ public:
   RfMoritzClass();
 	void init(void);
 	void task(void);
+	void read(void);
 	void func(char *in);
 	static uint8_t autoAckAddr[3];
 	static uint8_t fakeWallThermostatAddr[3];
 	uint8_t on(uint8_t onNew = 2);
+	uint8_t is_on(void) { return onState; } // for the GDO2 ISR, on() is in flash
 private:
   uint8_t onState;
   uint32_t lastSendingTicks;
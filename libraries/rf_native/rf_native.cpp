@@ -17,8 +17,12 @@
 #include "rf_receive.h"
 #include "display.h"
 #include "stringfunc.h"
+#include "rf_pktq.h"
 
 #include "rf_native.h"
+#ifdef HAS_RF_FRAME
+#  include "rf_frame.h"
+#endif
 //doppelt #include "cc1100.h"
 
 #ifdef LACROSSE_HMS_EMU
@@ -131,49 +135,79 @@ void RfNativeClass::native_init(uint8_t mode) {
   MYDELAY.my_delay_ms(1);
 }
 
+// Move the FIFO to RfPktq once CC1100_FIFOTHR bytes have arrived (GDO2
+// high), called by the GDO2 ISR, or by native_task() if the SPI was in use.
+void ICACHE_RAM_ATTR RfNativeClass::read(void) {
+  rf_pkt_t *p = RfPktq.slot();
+  if (!p)
+    return;
+
+  p->us = micros();                  // XT: read, not the sync time
+
+  // start over syncing
+  CC1100.ccStrobe( CC1100_SIDLE );
+
+  p->len = CC1100.cc1100_readReg( CC1100_RXBYTES ) & 0x7f; // read len, transfer RX fifo
+  if (!p->len)
+    return;
+  if (p->len > RF_PKT_MAX)
+    p->len = RF_PKT_MAX;
+  RfPktq.burst(p->data, p->len);
+  RfPktq.put();
+
+  // and listen again, as native_task did on the next call
+  CC1100.ccStrobe( CC1100_SFRX  );
+  CC1100.ccStrobe( CC1100_SIDLE );
+  CC1100.ccStrobe( CC1100_SNOP  );
+  CC1100.ccStrobe( CC1100_SRX   );
+}
+
 void RfNativeClass::native_task(void) {
-  uint8_t len, byte, i;
+  uint8_t len;
+  uint8_t msg[1+RF_PKT_MAX];           // mode and the RX FIFO
+  rf_pkt_t *p;
 
   if(!native_on)
     return;
 
-  // wait for CC1100_FIFOTHR given bytes to arrive in FIFO:
+  // wait for CC1100_FIFOTHR given bytes to arrive in FIFO, if the ISR did not
   if (bit_is_set( CC1100_IN_PORT, CC1100_IN_PIN )) {
+    CC1100.spi_busy++;
+    read();
+    CC1100.spi_busy--;
+  }
 
-    // start over syncing
-    CC1100.ccStrobe( CC1100_SIDLE );
-
-    len = CC1100.cc1100_readReg( CC1100_RXBYTES ) & 0x7f; // read len, transfer RX fifo
-    
-    if (len) {
-      
-      CC1100_ASSERT;
-      CC1100.cc1100_sendbyte( CC1100_READ_BURST | CC1100_RXFIFO );
+  if ((p = RfPktq.get())) {
+    uint32_t us = p->us;
 
-      DC( 'N' );
-      DH2(native_on);
-
-      for (i=0; i<len; i++) {
-	byte = CC1100.cc1100_sendbyte( 0 );
+    len = p->len;
+    msg[0] = native_on;
+    memcpy(msg+1, p->data, len);
+    RfPktq.drop();
 
 #if defined(LACROSSE_HMS_EMU)
-	if (i<sizeof(payload))
-	  payload[i] = byte;
+    for (uint8_t i=0; i<len && i<sizeof(payload); i++)
+      payload[i] = msg[i+1];
+#endif
+
+#ifdef HAS_RF_FRAME
+    if (RfFrame.mode == FRAME_BINARY) {
+      RfFrame.send('N', msg, len+1, 0, 0, 0, us);
+    } else
 #endif
-	DH2( byte );
-      }
-      
-      CC1100_DEASSERT;
-      
+    {
+      DC( 'N' );
+      display.hexbuf(msg, len+1);
+      if (RfReceive.stamp)
+        RfReceive.stamp_display(us);
       DNL();
+    }
 
 #ifdef LACROSSE_HMS_EMU
-      if (len>=5)
-	dec2hms_lacrosse(payload);
+    if (len>=5)
+      dec2hms_lacrosse(payload);
 #endif
 
-    }
-
     return;
   }
        
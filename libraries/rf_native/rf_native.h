@@ -5,6 +5,8 @@ class RfNativeClass {
 public:
 	void native_task(void);
 	void native_func(char *in);
+	void read(void);
+	uint8_t on(void) { return native_on; }
 
 #ifdef LACROSSE_HMS_EMU
 	uint8_t payload[5];
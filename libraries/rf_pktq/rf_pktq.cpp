@@ -0,0 +1,51 @@
+#include "board.h"
+#include "cc1100.h"
+#include "rf_pktq.h"
+
+rf_pkt_t * ICACHE_RAM_ATTR RfPktqClass::slot(void)
+{
+  if((uint8_t)(in - out) >= RF_PKTQ_SIZE) {
+    overflow++;
+    return 0;
+  }
+  return &q[in & (RF_PKTQ_SIZE-1)];
+}
+
+rf_pkt_t *RfPktqClass::get(void)
+{
+  if(in == out)
+    return 0;
+  return &q[out & (RF_PKTQ_SIZE-1)];
+}
+
+// Read n bytes from the RX FIFO
+void ICACHE_RAM_ATTR RfPktqClass::burst(uint8_t *buf, uint8_t n)
+{
+  CC1100_ASSERT;
+  CC1100.cc1100_sendbyte( CC1100_READ_BURST | CC1100_RXFIFO );
+  for(uint8_t i = 0; i < n; i++)
+    buf[i] = CC1100.cc1100_sendbyte( 0 );
+  CC1100_DEASSERT;
+}
+
+// Status register (RXBYTES, MARCSTATE), read until two reads agree
+// (CC1101 errata)
+uint8_t ICACHE_RAM_ATTR RfPktqClass::status(uint8_t addr)
+{
+  uint8_t v, last = 0, n = 8;
+
+  do {
+    CC1100_ASSERT;
+    CC1100.cc1100_sendbyte( addr | CC1100_READ_BURST );
+    v = CC1100.cc1100_sendbyte( 0 );
+    CC1100_DEASSERT;
+    if(n < 8 && v == last)
+      break;
+    last = v;
+  } while(--n);
+  return v;
+}
+
+#if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_RF_PKTQ)
+RfPktqClass RfPktq;
+#endif
@@ -0,0 +1,37 @@
+#ifndef _RF_PKTQ_H
+#define _RF_PKTQ_H
+
+#include <Arduino.h>
+
+// Packets read from the CC1101 RX FIFO by the packet mode receivers (AskSin,
+// MAX!, native), in the GDO2 ISR with HAS_RF_PKT_ISR, else in their task.
+#define RF_PKTQ_SIZE   4                // power of 2
+#define RF_PKT_MAX     64               // the RX FIFO
+
+typedef struct {
+	uint32_t us;                    // micros() when read, XT
+	uint8_t len, rssi, lqi;
+	uint8_t data[RF_PKT_MAX];
+} rf_pkt_t;
+
+class RfPktqClass {
+public:
+	uint16_t overflow;              // reads put off, the queue was full
+
+	rf_pkt_t *slot(void);           // reader: free slot, 0 if full
+	void put(void) { in++; }        // reader: slot filled
+	rf_pkt_t *get(void);            // task: oldest packet, 0 if none
+	void drop(void) { out++; }      // task: done with get()
+	void burst(uint8_t *buf, uint8_t n);
+	uint8_t status(uint8_t addr);   // status register, ISR safe
+
+private:
+	rf_pkt_t q[RF_PKTQ_SIZE];
+	volatile uint8_t in, out;
+};
+
+#if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_RF_PKTQ)
+extern RfPktqClass RfPktq;
+#endif
+
+#endif
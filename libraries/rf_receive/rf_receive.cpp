@@ -8,7 +8,7 @@
   #include <avr/interrupt.h>
 #endif
 #include <stdio.h>
-#include <parity.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "board.h"
@@ -29,6 +29,12 @@
 #  include "fastrf.h"
 #endif
 #include "rf_router.h"
+#ifdef HAS_RF_FRAME
+#  include "rf_frame.h"
+#endif
+#ifdef HAS_RF_LATENCY
+#  include "latency.h"
+#endif
 
 #ifdef HAS_ASKSIN
 #  include "rf_asksin.h"
@@ -36,6 +42,9 @@
 #ifdef HAS_MBUS
 #  include "rf_mbus.h"
 #endif
+#ifdef HAS_ZWAVE
+#  include "rf_zwave.h"
+#endif
 
 //////////////////////////
 // With a CUL measured RF timings, in us, high/low sum
@@ -85,6 +94,34 @@
 
 uint8_t tx_report;              // global verbose / output-filter
 
+// Protocols counted by XS, in output order
+static const char rcv_types[] = {
+  TYPE_FS20, TYPE_FHT, TYPE_EM, TYPE_KS300, TYPE_HMS,
+#ifdef HAS_TX3
+  TYPE_TX3,
+#endif
+#ifdef HAS_ESA
+  TYPE_ESA,
+#endif
+#ifdef HAS_HOERMANN
+  TYPE_HRM,
+#endif
+#ifdef HAS_TCM97001
+  TYPE_TCM97001,
+#endif
+#ifdef HAS_REVOLT
+  TYPE_REVOLT,
+#endif
+#ifdef HAS_IT
+  TYPE_IT,
+#endif
+#ifdef HAS_FTZ
+  TYPE_FTZ,
+#endif
+};
+static_assert(sizeof(rcv_types) <= RCV_TYPES, "RCV_TYPES too small");
+static_assert((REP_CACHE & (REP_CACHE-1)) == 0, "REP_CACHE must be a power of 2");
+
 void RfReceiveClass::tx_init(void)
 {
   SET_BIT  ( CC1100_OUT_DDR,  CC1100_OUT_PIN);
@@ -95,20 +132,131 @@ void RfReceiveClass::tx_init(void)
 
   RfSend.credit_10ms = MAX_CREDIT/2;
 
-  for(int i = 1; i < RCV_BUCKETS; i ++)
-    bucket_array[i].state = STATE_RESET;
+  set_buckets(FNcol.erb(EE_RCV_BUCKETS));
+  reptime = FNcol.erb(EE_REPTIME);
+  if(reptime == 0xff)                   // erased, e.g. after an upgrade
+    reptime = REPTIME;
+  stamp = FNcol.erb(EE_RF_STAMP) == 1;  // 0xff after an upgrade: off
   cc_on = 0;
 }
 
+// Up to RCV_BUCKETS the static pool is used, above that the heap.
+// Messages waiting for the analyzer are dropped.
+void RfReceiveClass::set_buckets(uint8_t n)
+{
+  if(n < RCV_BUCKETS_MIN || n > RCV_BUCKETS_MAX)
+    n = RCV_BUCKETS;
+
+  bucket_t *a = bucket_pool;
+  if(n > RCV_BUCKETS) {
+    a = (bucket_t *)malloc(n * sizeof(bucket_t));
+    if(!a) {
+      a = bucket_pool;
+      n = RCV_BUCKETS;
+    }
+  }
+  for(uint8_t i = 0; i < n; i++)
+    a[i].state = STATE_RESET;
+
+  bucket_t *old = bucket_array;
+  noInterrupts();
+  bucket_array = a;
+  bucket_cnt = n;
+  bucket_in = bucket_out = bucket_nrused = 0;
+  interrupts();
+  if(old && old != bucket_pool)
+    free(old);
+  stat_hwm = 0;
+}
+
+// XB: report, XBnn: set and save the number of buckets (hex)
+void RfReceiveClass::buckets_func(char *in)
+{
+  uint8_t n;
+
+  if(STRINGFUNC.fromhex(in+2, &n, 1)) {
+    set_buckets(n);
+    FNcol.ewb(EE_RCV_BUCKETS, bucket_cnt);
+  }
+  DH2(bucket_cnt);
+  DNL();
+}
+
+// XR<nn>: a message seen again within nn/125 sec is a repeat (EEPROM)
+void RfReceiveClass::reptime_func(char *in)
+{
+  if(STRINGFUNC.fromhex(in+2, &reptime, 1)) {
+    if(reptime == 0xff)
+      reptime = REPTIME;
+    FNcol.ewb(EE_REPTIME, reptime);
+  }
+  DH2(reptime);
+  DNL();
+}
+
+// XT<nn>: 01 appends the reception time to every message (EEPROM)
+void RfReceiveClass::stamp_func(char *in)
+{
+  uint8_t n;
+  if(STRINGFUNC.fromhex(in+2, &n, 1)) {
+    stamp = n == 1;
+    FNcol.ewb(EE_RF_STAMP, stamp);
+  }
+  DH2(stamp);
+  DNL();
+}
+
+// @<seconds>.<microseconds>, epoch time once SNTP has set the clock
+void RfReceiveClass::stamp_display(uint32_t us)
+{
+  uint64_t t = CLOCK.stamp_us(us);
+  DC('@');
+  DU((uint32_t)(t / 1000000), 0);
+  DC('.');
+  display.udec((uint32_t)(t % 1000000), 6, '0');
+}
+
+// XS: report, XSr: report and clear the receiver statistics
+void RfReceiveClass::stats_func(char *in)
+{
+  DS("buckets:"); DU(bucket_cnt, 0);
+  DS(" used:");   DU(bucket_nrused, 0);
+  DS(" max:");    DU(stat_hwm, 0);
+  DS(" ovf:");    DU(stat_overflow, 0);
+  DS(" false:");  DU(stat_false, 0);
+  DS(" unknown:");DU(stat_unknown, 0);
+  DS(" rep:");    DU(stat_repeat, 0);
+#ifdef HAS_RF_EDGE_RING
+  DS(" eovf:");   DU(edge_overflow, 0);
+#endif
+  for(uint8_t i = 0; i < sizeof(rcv_types); i++) {
+    DC(' '); DC(rcv_types[i]); DC(':'); DU(stat_type[i], 0);
+  }
+  DNL();
+
+  if(in[2] == 'r') {
+    stat_hwm = bucket_nrused;
+    stat_overflow = stat_false = stat_unknown = stat_repeat = 0;
+    memset(stat_type, 0, sizeof(stat_type));
+#ifdef HAS_RF_EDGE_RING
+    edge_overflow = edge_reported = 0;
+#endif
+  }
+}
+
 void RfReceiveClass::set_txrestore()
 {
 #ifdef HAS_MBUS	
-  if(mbus_mode != WMBUS_NONE) {
-    // rf_mbus.c handles cc1101 configuration on its own.
+  if(RfMbus.on()) {
+    // RfMbus handles cc1101 configuration on its own.
     // if mbus is activated the configuration must not be
     // changed here, that leads to a crash!
     return;
   }
+#endif
+#ifdef HAS_ZWAVE
+  if(RfZwave.on())                      // as RfMbus
+    return;
 #endif
   if(tx_report) {
     CC1100.set_ccon();
@@ -128,6 +276,40 @@ void RfReceiveClass::set_txreport(char *in)
     DNL();
     return;
   }
+  if(in[1] == 'B') {
+    buckets_func(in);
+    return;
+  }
+  if(in[1] == 'S') {
+    stats_func(in);
+    return;
+  }
+  if(in[1] == 'R') {
+    reptime_func(in);
+    return;
+  }
+  if(in[1] == 'T') {
+    stamp_func(in);
+    return;
+  }
+#ifdef HAS_RF_LATENCY
+  if(in[1] == 'L') {
+    Latency.func(in);
+    return;
+  }
+#endif
+#ifdef HAS_RF_FRAME
+  if(in[1] == 'W') {
+    RfFrame.func(in);
+    return;
+  }
+#endif
+#ifdef HAS_RF_TX_TIMER
+  if(in[1] == 'Q') {
+    RfSend.queue_func(in);
+    return;
+  }
+#endif
 
   STRINGFUNC.fromhex(in+1, &tx_report, 1);
   set_txrestore();
@@ -168,111 +350,115 @@ uint8_t RfReceiveClass::cksum3(uint8_t *buf, uint8_t len)               // KS300
   return (y<<4)|x;
 }
 
+// Even parity of a byte, bit v&7 of parity_tab[v>>3]
+static const uint8_t parity_tab[32] = {
+  0x96, 0x69, 0x69, 0x96, 0x69, 0x96, 0x96, 0x69, 0x69, 0x96, 0x96, 0x69,
+  0x96, 0x69, 0x69, 0x96, 0x69, 0x96, 0x96, 0x69, 0x96, 0x69, 0x69, 0x96,
+  0x96, 0x69, 0x69, 0x96, 0x69, 0x96, 0x96, 0x69
+};
+#define PARITY(v)  ((parity_tab[(v)>>3] >> ((v)&7)) & 1)
+
+static const uint8_t rev4[16] = {               // bit reversed nibble
+  0x0, 0x8, 0x4, 0xc, 0x2, 0xa, 0x6, 0xe, 0x1, 0x9, 0x5, 0xd, 0x3, 0xb, 0x7, 0xf
+};
+#define REV8(v)    (rev4[(v)&0xf]<<4 | rev4[((v)>>4)&0xf])
+
+// nbits (max. 16) from the bucket, the first bit is the MSB of the result.
+// Reads a 24 bit window, bucket_t data has two bytes of read ahead.
+uint16_t RfReceiveClass::getword(input_t *in, uint8_t nbits)
+{
+  const uint8_t *p = in->data + (in->pos>>3);
+  uint32_t w = ((uint32_t)p[0]<<16 | p[1]<<8 | p[2]) << (in->pos&7);
+  in->pos += nbits;
+  return (w >> (24-nbits)) & ((1<<nbits)-1);
+}
+
+uint8_t RfReceiveClass::getbits(input_t* in, uint8_t nbits, uint8_t msb)
+{
+  uint8_t ret = getword(in, nbits);
+  if(!msb)
+    ret = REV8(ret) >> (8-nbits);
+  return ret;
+}
+
+// FS20: 8 bits MSB first + even parity, EM: 8 bits LSB first + 1,
+// KS300: 4 bits LSB first + 1 + 4 bits + 1. Trailing bits which are not a
+// complete group end up in obuf[oby].
 uint8_t RfReceiveClass::analyze(bucket_t *b, uint8_t t)
 {
-  uint8_t cnt=0, max, iby = 0;
-  int8_t ibi=7, obi=7;
+  input_t in = { b->data, 0 };
+  uint8_t max = b->byteidx*8+(7-b->bitidx), rest;
+  uint16_t w;
 
   nibble = 0;
   oby = 0;
-  max = b->byteidx*8+(7-b->bitidx);
-  obuf[0] = 0;
-  while(cnt++ < max) {
-
-    uint8_t bit = (b->data[iby] & _BV(ibi)) ? 1 : 0;     // Input bit
-    if(ibi-- == 0) {
-      iby++;
-      ibi=7;
-    }
 
-    if(t == TYPE_KS300 && obi == 3) {                   // nibble check
-      if(!nibble) {
-        if(!bit)
-          return 0;
-        nibble = !nibble;
-        continue;
-      }
-      nibble = !nibble;
+  if(t == TYPE_KS300) {
+    for(; max-in.pos >= 10; oby++) {
+      w = getword(&in, 10);
+      if((w & 0x21) != 0x21)                           // nibble and stop bit
+        return 0;
+      obuf[oby] = rev4[w>>6] | rev4[(w>>1)&0xf]<<4;
+    }
+    rest = max-in.pos;
+    w = rest ? getword(&in, rest) << (10-rest) : 0;
+    if(rest >= 5 && !(w & 0x20))
+      return 0;
+    obuf[oby] = rev4[w>>6] | rev4[(w>>1)&0xf]<<4;
+    if(rest == 5) {                                    // half byte msg
+      nibble = 1;
+      oby++;
     }
 
-    if(obi == -1) {                                    // next byte
-      if(t == TYPE_FS20) {
-        if(parity_even_bit(obuf[oby]) != bit)
-          return 0;
-      }
-      if(t == TYPE_EM || t == TYPE_KS300) {
-        if(!bit)
+  } else {
+    for(; max-in.pos >= 9; oby++) {
+      w = getword(&in, 9);
+      uint8_t d = w>>1;
+      if(t == TYPE_FS20 && PARITY(d) != (w&1))
+        return 0;
+      if(t == TYPE_EM) {
+        if(!(w&1))
           return 0;
+        d = REV8(d);                                   // LSB
       }
-      obuf[++oby] = 0;
-      obi = 7;
-
-    } else {                                           // Normal bits
-      if(bit) {
-        if(t == TYPE_FS20)
-          obuf[oby] |= _BV(obi);
-        if(t == TYPE_EM || t == TYPE_KS300)            // LSB
-          obuf[oby] |= _BV(7-obi);
-      }
-      obi--;
+      obuf[oby] = d;
     }
+    rest = max-in.pos;
+    w = rest ? getword(&in, rest) << (8-rest) : 0;
+    obuf[oby] = (t == TYPE_EM ? REV8(w) : w);
+    if(t == TYPE_EM && rest == 8)                      // missing last stopbit
+      oby++;
   }
-  if(cnt <= max)
-    return 0;
-  else if(t == TYPE_EM && obi == -1)                  // missing last stopbit
-    oby++;
-  else if(nibble)                                     // half byte msg 
-    oby++;
 
   if(oby == 0)
     return 0;
   return 1;
 }
 
-uint8_t RfReceiveClass::getbit(input_t *in)
-{
-  uint8_t bit = (in->data[in->byte] & _BV(in->bit)) ? 1 : 0;
-  if(in->bit-- == 0) {
-    in->byte++;
-    in->bit=7;
-  }
-  return bit;
-}
-
-uint8_t RfReceiveClass::getbits(input_t* in, uint8_t nbits, uint8_t msb)
-{
-  uint8_t ret = 0, i;
-  for (i = 0; i < nbits; i++) {
-    if (getbit(in) )
-      ret = ret | _BV( msb ? nbits-i-1 : i );
-  }
-  return ret;
-}
-
 uint8_t RfReceiveClass::analyze_hms(bucket_t *b)
 {
-  input_t in;
-  in.byte = 0;
-  in.bit = 7;
-  in.data = b->data;
+  input_t in = { b->data, 0 };
 
   oby = 0;
   if(b->byteidx*8 + (7-b->bitidx) < 69) 
     return 0;
 
   uint8_t crc = 0;
-  for(oby = 0; oby < 6; oby++) {
-    obuf[oby] = getbits(&in, 8, 0);
-    if(parity_even_bit(obuf[oby]) != getbit( &in ))
+  uint16_t w;
+  for(oby = 0; oby < 6; oby++) {         // 8 bits LSB first, parity, 0
+    w = getword(&in, 10);
+    obuf[oby] = REV8(w>>2);
+    if(PARITY(obuf[oby]) != ((w>>1)&1))
       return 0;
-    if(getbit(&in))
+    if(w&1)
       return 0;
     crc = crc ^ obuf[oby];
   }
 
   // Read crc
-  uint8_t CRC = getbits(&in, 8, 0);
-  if(parity_even_bit(CRC) != getbit(&in))
+  w = getword(&in, 9);
+  uint8_t CRC = REV8(w>>1);
+  if(PARITY(CRC) != (w&1))
     return 0;
   if(crc!=CRC)
     return 0;
@@ -282,10 +468,7 @@ uint8_t RfReceiveClass::analyze_hms(bucket_t *b)
 #ifdef HAS_FTZ
 uint8_t RfReceiveClass::analyze_ftz(bucket_t *b)
 {
-  input_t in;
-  in.byte = 0;
-  in.bit = 7;
-  in.data = b->data;
+  input_t in = { b->data, 0 };
   
   oby = 0;
   //8*8+5=69/10=6R9, 8*8+6=70/10=6R10 ?, 9*8+7=79/10=7R9 bit
@@ -298,18 +481,21 @@ uint8_t RfReceiveClass::analyze_ftz(bucket_t *b)
   uint8_t errorStopbit = 0;
   uint8_t errorCRC = 0;
   // Restbits lesen sinnvoll? Sonst ... -2;
+  uint16_t w;
   for(oby = 0; oby < b->byteidx-2; oby++) {
-    obuf[oby] = getbits(&in, 8, 0);
-    if(parity_even_bit(obuf[oby]) != getbit( &in ))
+    w = getword(&in, 10);
+    obuf[oby] = REV8(w>>2);
+    if(PARITY(obuf[oby]) != ((w>>1)&1))
 	  errorParity++; //return 0; //{DS("pe");DU(oby,3);DU(obuf[oby],3);}//
-    if(getbit(&in))
+    if(w&1)
 	  errorStopbit++; //return 0; //{DS("pn1");DU(oby,3);}//
     crc = crc ^ obuf[oby];
   }
   // Read crc
-  uint8_t CRC = getbits(&in, 8, 0);
+  w = getword(&in, 9);
+  uint8_t CRC = REV8(w>>1);
 
-  if(parity_even_bit(CRC) != getbit(&in)) {
+  if(PARITY(CRC) != (w&1)) {
 	//obuf[++oby] = CRC;
 	errorParity++; //return 0; //{DS("ce");DU(CRC,3);}//
   } else {
@@ -360,10 +546,7 @@ uint8_t RfReceiveClass::analyze_ftz(bucket_t *b)
 #ifdef HAS_ESA
 uint8_t RfReceiveClass::analyze_esa(bucket_t *b)
 {
-  input_t in;
-  in.byte = 0;
-  in.bit = 7;
-  in.data = b->data;
+  input_t in = { b->data, 0 };
 
 
   if (b->state != STATE_ESA)
@@ -403,10 +586,7 @@ uint8_t RfReceiveClass::analyze_esa(bucket_t *b)
 #ifdef HAS_TX3
 uint8_t RfReceiveClass::analyze_TX3(bucket_t *b)
 {
-  input_t in;
-  in.byte = 0;
-  in.bit = 7;
-  in.data = b->data;
+  input_t in = { b->data, 0 };
   uint8_t n, crc = 0;
 
   if(b->byteidx != 4 || b->bitidx != 1)
@@ -476,6 +656,213 @@ uint8_t RfReceiveClass::analyze_revolt(bucket_t *b)
 }
 #endif
 
+//////////////////////////////////////////////////////////////////////
+// Pulse width coded protocols, they share STATE_COLLECT
+
+uint8_t RfReceiveClass::decode_fs20(bucket_t *b)
+{
+  if(!analyze(b, TYPE_FS20))             // Can be FS10 (433Mhz) or FS20 (868MHz)
+    return 0;
+  oby--;                                  // Separate the checksum byte
+  uint8_t fs_csum = cksum1(6,obuf,oby);
+  if(fs_csum == obuf[oby] && oby >= 4)
+    return TYPE_FS20;
+
+  if(fs_csum+1 == obuf[oby] && oby >= 4) {      // Repeater
+    obuf[oby] = fs_csum;                  // do not report if we get both
+    return TYPE_FS20;
+  }
+  if(cksum1(12, obuf, oby) == obuf[oby] && oby >= 4)
+    return TYPE_FHT;
+  return 0;
+}
+
+uint8_t RfReceiveClass::decode_em(bucket_t *b)
+{
+  if(!analyze(b, TYPE_EM))
+    return 0;
+  oby--;
+  if(oby == 9 && cksum2(obuf, oby) == obuf[oby])
+    return TYPE_EM;
+  return 0;
+}
+
+uint8_t RfReceiveClass::decode_ks300(bucket_t *b)
+{
+  // As there is no last rise, we have to add the last bit by hand
+  addbit(b, wave_equals(&b->one, b->lasthigh, b->one.lowtime, b->state));
+  if(analyze(b, TYPE_KS300)) {
+    oby--;
+    if(cksum3(obuf, oby) == obuf[oby-nibble])
+      return TYPE_KS300;
+  }
+  delbit(b);
+  return 0;
+}
+
+#ifdef HAS_HOERMANN
+// This protocol is not yet understood. It should be last in the row!
+uint8_t RfReceiveClass::decode_hrm(bucket_t *b)
+{
+  if(b->byteidx != 4 || b->bitidx != 4 ||
+     !wave_equals(&b->zero, TSCALE(960), TSCALE(480), b->state))
+    return 0;
+
+  addbit(b, wave_equals(&b->one, b->lasthigh, TSCALE(480), b->state));
+  for(oby=0; oby < 5; oby++)
+    obuf[oby] = b->data[oby];
+  return TYPE_HRM;
+}
+#endif
+
+#ifdef RF_ANALYZE_CHAIN
+// Reference: try every decoder in turn (tools/host compares both)
+uint8_t RfReceiveClass::decode(bucket_t *b)
+{
+  uint8_t datatype = 0;
+
+#ifdef HAS_IT
+  if(b->state == STATE_IT || b->state == STATE_ITV3) {
+    if(!datatype && analyze_it(b)) { 
+    datatype = TYPE_IT;
+    }
+  }
+#endif
+#ifdef HAS_TCM97001
+  if(!datatype && analyze_tcm97001(b))
+    datatype = TYPE_TCM97001;
+#endif
+#ifdef HAS_REVOLT
+  if(!datatype && analyze_revolt(b))
+    datatype = TYPE_REVOLT;
+#endif
+#ifdef LONG_PULSE
+  if(b->state != STATE_REVOLT && b->state != STATE_IT && b->state != STATE_TCM97001) {
+#endif
+#ifdef HAS_ESA
+  if(!datatype && analyze_esa(b))
+    datatype = TYPE_ESA;
+#endif
+  if(!datatype)
+    datatype = decode_fs20(b);
+  if(!datatype)
+    datatype = decode_em(b);
+  if(!datatype && analyze_hms(b))
+    datatype = TYPE_HMS;
+#ifdef HAS_TX3
+  if(!datatype && analyze_TX3(b)) // Can be 433Mhz or 868MHz
+    datatype = TYPE_TX3;
+#endif
+#ifdef HAS_FTZ
+  if(!datatype && analyze_ftz(b)) // 868MHz
+    datatype = TYPE_FTZ;
+#endif
+  if(!datatype)
+    datatype = decode_ks300(b);
+#ifdef HAS_HOERMANN
+  if(!datatype)
+    datatype = decode_hrm(b);
+#endif
+#ifdef LONG_PULSE
+  }
+#endif
+  return datatype;
+}
+
+#else
+// The sync already classified the bucket (state), the bit count selects
+// the decoders which can match. Only these are tried, in the order above.
+uint8_t RfReceiveClass::decode(bucket_t *b)
+{
+  uint8_t datatype = 0;
+  uint8_t nbits = b->byteidx*8 + (7-b->bitidx);
+
+  switch(b->state) {
+#ifdef HAS_IT
+  case STATE_IT:
+  case STATE_ITV3:
+    if(analyze_it(b))
+      datatype = TYPE_IT;
+    return datatype;
+#endif
+#ifdef HAS_TCM97001
+  case STATE_TCM97001:
+    if(analyze_tcm97001(b))
+      datatype = TYPE_TCM97001;
+    return datatype;
+#endif
+#ifdef HAS_REVOLT
+  case STATE_REVOLT:
+    if(analyze_revolt(b))
+      datatype = TYPE_REVOLT;
+    return datatype;
+#endif
+#ifdef HAS_ESA
+  case STATE_ESA:
+    if(analyze_esa(b))
+      datatype = TYPE_ESA;
+    return datatype;
+#endif
+  case STATE_HMS:                         // one bit per edge
+  case STATE_FTZ:
+    if(analyze_hms(b))
+      datatype = TYPE_HMS;
+#ifdef HAS_FTZ
+    else if(analyze_ftz(b))
+      datatype = TYPE_FTZ;
+#endif
+    return datatype;
+  }
+
+  // STATE_COLLECT, 9 bits per byte for FS20/FHT, 10 bytes for EM
+  if(nbits >= 5*9)
+    datatype = decode_fs20(b);
+  if(!datatype && nbits >= 10*9-1 && nbits <= 11*9-2)
+    datatype = decode_em(b);
+  if(!datatype && analyze_hms(b))          // short sync
+    datatype = TYPE_HMS;
+#ifdef HAS_TX3
+  if(!datatype && nbits == 38 && analyze_TX3(b))
+    datatype = TYPE_TX3;
+#endif
+#ifdef HAS_FTZ
+  if(!datatype && analyze_ftz(b))
+    datatype = TYPE_FTZ;
+#endif
+  if(!datatype)
+    datatype = decode_ks300(b);
+#ifdef HAS_HOERMANN
+  if(!datatype)
+    datatype = decode_hrm(b);
+#endif
+  return datatype;
+}
+#endif
+
+// Look the message up in rep_cache: 1 if it was received within reptime.
+// The entry is refreshed, a repeated message stays a repeat while it is
+// being sent. Different messages only displace each other on a hash
+// collision, so interleaved repeats of several senders are caught.
+uint8_t RfReceiveClass::rep_check(uint8_t type)
+{
+  uint16_t h = type;
+  for(uint8_t i = 0; i < oby; i++)
+    h = h * 31 + obuf[i];
+  rep_entry_t *e = rep_cache + ((h ^ (h >> 8)) & (REP_CACHE-1));
+
+  uint8_t rep = 0;
+  if(e->type == type && e->len == oby && !memcmp(e->data, obuf, oby)) {
+    rep = (CLOCK.ticks - e->time < reptime);
+  } else {
+    e->type = type;
+    e->len = oby;
+    memcpy(e->data, obuf, oby);
+    packetCheckValues.isnotrep = 0;
+  }
+  e->time = CLOCK.ticks;
+  return rep;
+}
+
 /*
  * Check for repeted message.
  * When Package is for e.g. IT or TCM, than there must be received two packages
@@ -506,6 +893,10 @@ void RfReceiveClass::RfAnalyze_Task(void)
   uint8_t datatype = 0;
   bucket_t *b;
 
+#ifdef HAS_RF_EDGE_RING
+  edge_drain();
+#endif
+
   if(lowtime) {
 #ifndef NO_RF_DEBUG
     //DH(tx_report,1);
@@ -540,6 +931,13 @@ void RfReceiveClass::RfAnalyze_Task(void)
 		DNL();
 		overflow = 0;
 	}
+#ifdef HAS_RF_EDGE_RING
+	if( (tx_report & REP_BITS) && edge_overflow != edge_reported) {
+		DS("EOVF");
+		DNL();
+		edge_reported = edge_overflow;
+	}
+#endif
 #endif // NO_RF_DEBUG
     lowtime = 0;
   }
@@ -552,113 +950,37 @@ void RfReceiveClass::RfAnalyze_Task(void)
 
   b = bucket_array + bucket_out;
 
-#ifdef HAS_IT
-  if(b->state == STATE_IT || b->state == STATE_ITV3) {
-    if(!datatype && analyze_it(b)) { 
-    datatype = TYPE_IT;
-    }
+#ifdef RF_ANALYZE_REPEAT                  // tools/host: rfreplay -b
+  for(uint16_t i = 0; i < RF_ANALYZE_REPEAT; i++) {
+    bucket_t t = *b;
+    decode(&t);
   }
 #endif
-#ifdef HAS_TCM97001
-  if(!datatype && analyze_tcm97001(b))
-    datatype = TYPE_TCM97001;
+#ifdef HAS_RF_LATENCY
+  uint32_t lat_start = micros();
 #endif
-#ifdef HAS_REVOLT
-  if(!datatype && analyze_revolt(b))
-    datatype = TYPE_REVOLT;
-#endif
-#ifdef LONG_PULSE
-  if(b->state != STATE_REVOLT && b->state != STATE_IT && b->state != STATE_TCM97001) {
-#endif
-#ifdef HAS_ESA
-  if(!datatype && analyze_esa(b))
-    datatype = TYPE_ESA;
+  datatype = decode(b);
+#ifdef HAS_RF_LATENCY
+  uint32_t lat_decoded = micros();
 #endif
-  if(!datatype && analyze(b, TYPE_FS20)) { // Can be FS10 (433Mhz) or FS20 (868MHz)
-    oby--;                                  // Separate the checksum byte
-    uint8_t fs_csum = cksum1(6,obuf,oby);
-    if(fs_csum == obuf[oby] && oby >= 4) {
-      datatype = TYPE_FS20;
 
-    } else if(fs_csum+1 == obuf[oby] && oby >= 4) {     // Repeater
-      datatype = TYPE_FS20;
-      obuf[oby] = fs_csum;                  // do not report if we get both
-
-    } else if(cksum1(12, obuf, oby) == obuf[oby] && oby >= 4) {
-      datatype = TYPE_FHT;
-    } else {
-      datatype = 0;
-    }
-  }
-
-  if(!datatype && analyze(b, TYPE_EM)) {
-    oby--;                                 
-    if(oby == 9 && cksum2(obuf, oby) == obuf[oby])
-      datatype = TYPE_EM;
-  }
-
-  if(!datatype && analyze_hms(b))
-    datatype = TYPE_HMS;
-
-#ifdef HAS_TX3
-  if(!datatype && analyze_TX3(b)) // Can be 433Mhz or 868MHz
-    datatype = TYPE_TX3;
-#endif
-#ifdef HAS_FTZ
-  if(!datatype && analyze_ftz(b)) // 868MHz
-    datatype = TYPE_FTZ;
-#endif
-
-  if(!datatype) {
-    // As there is no last rise, we have to add the last bit by hand
-    addbit(b, wave_equals(&b->one, hightime, b->one.lowtime, b->state));
-    if(analyze(b, TYPE_KS300)) {
-      oby--;                                 
-      if(cksum3(obuf, oby) == obuf[oby-nibble])
-        datatype = TYPE_KS300;
-    }
-    if(!datatype)
-      delbit(b);
-  }
-
-#ifdef HAS_HOERMANN
-  // This protocol is not yet understood. It should be last in the row!
-  if(!datatype && b->byteidx == 4 && b->bitidx == 4 &&
-     wave_equals(&b->zero, TSCALE(960), TSCALE(480), b->state)) {
-
-    addbit(b, wave_equals(&b->one, hightime, TSCALE(480), b->state));
-    for(oby=0; oby < 5; oby++)
-      obuf[oby] = b->data[oby];
-    datatype = TYPE_HRM;
-  }
-#endif
-#ifdef LONG_PULSE
+  if(datatype) {
+    const char *t = (const char *)memchr(rcv_types, datatype, sizeof(rcv_types));
+    if(t)
+      stat_type[t-rcv_types]++;
+  } else {
+    stat_unknown++;
   }
-#endif
 
   if(datatype && (tx_report & REP_KNOWN)) {
 
     packetCheckValues.isrep = 0;
     packetCheckValues.packageOK = 0;
     if(!(tx_report & REP_REPEATED)) {      // Filter repeated messages
-      
-      // compare the data
-      if(roby == oby) {
-        for(roby = 0; roby < oby; roby++)
-          if(robuf[roby] != obuf[roby]) {
-            packetCheckValues.isnotrep = 0;
-            break;
-          }
-
-        if(roby == oby && (CLOCK.ticks - reptime < REPTIME)) // 38/125 = 0.3 sec
-          packetCheckValues.isrep = 1;
+      if(rep_check(datatype)) {
+        packetCheckValues.isrep = 1;
+        stat_repeat++;
       }
-
-      // save the data
-      for(roby = 0; roby < oby; roby++)
-        robuf[roby] = obuf[roby];
-      reptime = CLOCK.ticks;
-
     }
 
     if(datatype == TYPE_FHT && !(tx_report & REP_FHTPROTO) &&
@@ -677,16 +999,31 @@ void RfReceiveClass::RfAnalyze_Task(void)
 #endif
 
     if(packetCheckValues.packageOK) {
-      DC(datatype);
-      if(nibble)
-        oby--;
-      for(uint8_t i=0; i < oby; i++)
-        DH2(obuf[i]);
-      if(nibble)
-        DH(obuf[oby]&0xf,1);
-      if(tx_report & REP_RSSI)
-        DH2(CC1100.readStatus(CC1100_RSSI));
-      DNL();
+#ifdef HAS_RF_LATENCY
+      uint32_t lat_queued = micros();
+#endif
+#ifdef HAS_RF_FRAME
+      if(RfFrame.mode == FRAME_BINARY) {
+        RfFrame.send(datatype, obuf, oby, FRAME_RSSI|(nibble?FRAME_NIBBLE:0),
+                     CC1100.readStatus(CC1100_RSSI), 0, b->time);
+      } else
+#endif
+      {
+        DC(datatype);
+        if(nibble)
+          oby--;
+        display.hexbuf(obuf, oby);
+        if(nibble)
+          DH(obuf[oby]&0xf,1);
+        if(tx_report & REP_RSSI)
+          DH2(CC1100.readStatus(CC1100_RSSI));
+        if(stamp)
+          stamp_display(b->time);
+        DNL();
+      }
+#ifdef HAS_RF_LATENCY
+      Latency.frame(b->eop, lat_start, lat_decoded, lat_queued, micros());
+#endif
     }
 
   }
@@ -712,8 +1049,7 @@ void RfReceiveClass::RfAnalyze_Task(void)
     if(b->bitidx != 7)
       b->byteidx++;
 
-    for(uint8_t i=0; i < b->byteidx; i++)
-       DH2(b->data[i]);
+    display.hexbuf(b->data, b->byteidx);
     DNL();
 
   }
@@ -722,7 +1058,7 @@ void RfReceiveClass::RfAnalyze_Task(void)
   b->state = STATE_RESET;
   bucket_nrused--;
   bucket_out++;
-  if(bucket_out == RCV_BUCKETS)
+  if(bucket_out == bucket_cnt)
     bucket_out = 0;
 
   LED_OFF();
@@ -750,6 +1086,16 @@ void ICACHE_RAM_ATTR RfReceiveClass::reset_input(void)
 //esp8266 ISR(TIMER1_COMPA_vect)
 void ICACHE_RAM_ATTR RfReceiveClass::IsrTimer1(void)
 {
+#ifdef HAS_RF_EDGE_RING
+  edge_push(EDGE_SILENCE, micros());
+#else
+  edge_now = micros();
+  silence_timeout();
+#endif
+}
+
+void ICACHE_RAM_ATTR RfReceiveClass::silence_timeout(void)
+{
 #ifdef LONG_PULSE
   uint16_t tmp;
 #endif
@@ -769,6 +1115,8 @@ void ICACHE_RAM_ATTR RfReceiveClass::IsrTimer1(void)
 ////////////////////test
   if(bucket_array[bucket_in].state < STATE_COLLECT ||
      bucket_array[bucket_in].byteidx < 2) {    // false alarm
+    if(bucket_array[bucket_in].state != STATE_RESET)
+      stat_false++;
     reset_input();
     return;
   }
@@ -777,7 +1125,7 @@ void ICACHE_RAM_ATTR RfReceiveClass::IsrTimer1(void)
    DC('+');
 #endif
 
-  if(bucket_nrused+1 == RCV_BUCKETS) {   // each bucket is full: reuse the last
+  if(bucket_nrused+1 == bucket_cnt) {    // each bucket is full: reuse the last
 
 #ifndef NO_RF_DEBUG
     if(tx_report & REP_BITS)
@@ -785,13 +1133,18 @@ void ICACHE_RAM_ATTR RfReceiveClass::IsrTimer1(void)
 #endif
 
 	overflow = 1; // Bucket overflow
+	stat_overflow++;
 	reset_input();
 
   } else {
 
+    bucket_array[bucket_in].lasthigh = hightime;
+    bucket_array[bucket_in].eop = edge_now;
     bucket_nrused++;
+    if(bucket_nrused > stat_hwm)
+      stat_hwm = bucket_nrused;
     bucket_in++;
-    if(bucket_in == RCV_BUCKETS)
+    if(bucket_in == bucket_cnt)
       bucket_in = 0;
 
   }
@@ -832,7 +1185,7 @@ uint8_t RfReceiveClass::makeavg(uint8_t i, uint8_t j)
 
 void ICACHE_RAM_ATTR RfReceiveClass::addbit(bucket_t *b, uint8_t bit)
 {
-  if(b->byteidx>=sizeof(b->data)){
+  if(b->byteidx>=MAXMSG){
     reset_input();
     return;
   }
@@ -884,18 +1237,105 @@ void ICACHE_RAM_ATTR RfReceiveClass::IsrHandler()
     return;
   }
 #endif
-#ifdef ESP8266
-# ifdef LONG_PULSE
-    uint16_t c = ((((T1L) - timer1_read())/5)>>4);               // catch the time and make it smaller
-# else
-    uint8_t c = ((((T1L) - timer1_read())/5)>>4);               // catch the time and make it smaller
-# endif
+#ifdef HAS_RF_EDGE_RING
+  // Only timestamp the edge, RfAnalyze_Task classifies it
+  uint16_t t = ((T1L) - timer1_read())/5;     // us since the previous edge
+  timer1_write(OCR1A);
+  edge_push((t << 1) | (bit_is_set(CC1100_IN_PORT,CC1100_IN_PIN) ? 1 : 0),
+            micros());
 #else
-# ifdef LONG_PULSE
-    uint16_t c = (TCNT1>>4);               // catch the time and make it smaller
+  edge_now = micros();
+# ifdef ESP8266
+  classify_edge(((T1L) - timer1_read())/5,
+                bit_is_set(CC1100_IN_PORT,CC1100_IN_PIN));
 # else
-    uint8_t c = (TCNT1>>4);               // catch the time and make it smaller
+  classify_edge(TCNT1, bit_is_set(CC1100_IN_PORT,CC1100_IN_PIN));
 # endif
+#endif
+}
+
+#ifdef HAS_RF_EDGE_RING
+// Single producer (the ISRs) / single consumer (RfAnalyze_Task) ring,
+// an entry is the time since the previous edge in us << 1 | GDO2 level,
+// edge_us has the micros() of the edge.
+void ICACHE_RAM_ATTR RfReceiveClass::edge_push(uint16_t e, uint32_t us)
+{
+  uint16_t in = edge_in;
+  uint16_t space = HAS_RF_EDGE_RING -
+                   (in - __atomic_load_n(&edge_out, __ATOMIC_ACQUIRE));
+
+  if(edge_gap) {                        // lost edges: terminate the message
+    if(space < 2) {
+      edge_overflow++;
+      return;
+    }
+    edge_us[in & (HAS_RF_EDGE_RING-1)] = us;
+    edge_ring[in++ & (HAS_RF_EDGE_RING-1)] = EDGE_SILENCE;
+    edge_gap = 0;
+  } else if(space == 0) {
+    edge_overflow++;
+    edge_gap = 1;
+    return;
+  }
+  edge_us[in & (HAS_RF_EDGE_RING-1)] = us;
+  edge_ring[in++ & (HAS_RF_EDGE_RING-1)] = e;
+  __atomic_store_n(&edge_in, in, __ATOMIC_RELEASE);
+}
+
+// Classify the queued edges. The timer1 restarts of the classifier are
+// replayed against the edge times, so the buckets are the same as when
+// classifying in the ISR.
+void RfReceiveClass::edge_drain(void)
+{
+  uint16_t out = edge_out;
+  uint16_t in = __atomic_load_n(&edge_in, __ATOMIC_ACQUIRE);
+
+  while(out != in) {
+    uint16_t e = edge_ring[out & (HAS_RF_EDGE_RING-1)];
+    uint32_t t = edge_time + (e >> 1) - edge_t1;
+
+    if(e != EDGE_SILENCE && !(edge_t1_armed && t >= OCR1A/5)) {
+      edge_now = edge_us[out & (HAS_RF_EDGE_RING-1)];
+      __atomic_store_n(&edge_out, ++out, __ATOMIC_RELEASE);
+      edge_time += e >> 1;
+      classify_edge(t > OCR1A/5 ? OCR1A/5 : t, e & 1);
+      continue;
+    }
+
+    if(e == EDGE_SILENCE) {             // else expired before this edge
+      edge_now = edge_us[out & (HAS_RF_EDGE_RING-1)];
+      __atomic_store_n(&edge_out, ++out, __ATOMIC_RELEASE);
+    } else {
+      edge_now += edge_t1 + OCR1A/5 - edge_time;
+    }
+    if(edge_t1_armed) {
+      edge_t1_armed = 0;
+      silence_timeout();
+    }
+  }
+}
+#endif
+
+void ICACHE_RAM_ATTR RfReceiveClass::restart_timer(void)
+{
+#if defined(HAS_RF_EDGE_RING)
+  edge_t1 = edge_time;                  // the ISR restarts the real one
+  edge_t1_armed = 1;
+#elif defined(ESP8266)
+  timer1_write(OCR1A); // restart timer
+#else
+  TCNT1 = 0;
+#endif
+}
+
+// Wave classification and bucket filling for one edge: t is the time in us
+// since the last restart_timer(), level the GDO2 level after the edge.
+void ICACHE_RAM_ATTR RfReceiveClass::classify_edge(uint32_t t, uint8_t level)
+{
+#ifdef LONG_PULSE
+  uint16_t c = t>>4;                    // catch the time and make it smaller
+#else
+  uint8_t c = t>>4;                     // catch the time and make it smaller
 #endif
 
   bucket_t *b = bucket_array+bucket_in; // where to fill in the bit
@@ -943,7 +1383,7 @@ void ICACHE_RAM_ATTR RfReceiveClass::IsrHandler()
 
   //////////////////
   // Falling edge
-  if(!bit_is_set(CC1100_IN_PORT,CC1100_IN_PIN)) {
+  if(!level) {
     if( (b->state == STATE_HMS)
 #ifdef HAS_ESA
      || (b->state == STATE_ESA) 
@@ -953,22 +1393,14 @@ void ICACHE_RAM_ATTR RfReceiveClass::IsrHandler()
 #endif
     ) {
       addbit(b, 1);
-#ifdef ESP8266
-      timer1_write(OCR1A); // restart timer
-#else
-      TCNT1 = 0;
-#endif
+      restart_timer();
     }
     hightime = c;
     return;
   }
 
   lowtime = c-hightime;
-#ifdef ESP8266
-  timer1_write(OCR1A); // restart timer
-#else
-  TCNT1 = 0;
-#endif
+  restart_timer();
 
 #ifdef HAS_IT
   if(b->state == STATE_IT || b->state == STATE_ITV3) {
@@ -980,11 +1412,7 @@ void ICACHE_RAM_ATTR RfReceiveClass::IsrHandler()
       if (lowtime > TSCALE(2400)) { 
         // this sould be the start bit for IT V3
         b->state = STATE_ITV3;
-#ifdef ESP8266
-        timer1_write(OCR1A); // restart timer
-#else
-        TCNT1 = 0;
-#endif
+        restart_timer();
         return;
       } else if (b->state == STATE_ITV3) {
         b->sync=1;
@@ -1053,6 +1481,7 @@ void ICACHE_RAM_ATTR RfReceiveClass::IsrHandler()
     b->one.lowtime = 14;
     b->sync=1;
     b->state = STATE_REVOLT;
+    b->time = edge_now;
     b->byteidx = 0;
     b->bitidx  = 7;
     b->data[0] = 0;
@@ -1065,6 +1494,7 @@ void ICACHE_RAM_ATTR RfReceiveClass::IsrHandler()
   if(b->state == STATE_RESET) {   // first sync bit, cannot compare yet
 
 retry_sync:
+    b->time = edge_now;
 
 #ifdef HAS_TCM97001
   if(hightime < TSCALE(530) && hightime > TSCALE(420) &&
@@ -1211,6 +1641,9 @@ retry_sync:
 uint8_t RfReceiveClass::rf_isreceiving()
 {
   uint8_t r = (bucket_array[bucket_in].state != STATE_RESET);
+#ifdef HAS_RF_EDGE_RING
+  r = (r || edge_in != edge_out);
+#endif
 #ifdef HAS_FHT_80b
   r = (r || FHT.fht80b_timeout != FHT_TIMER_DISABLED);
 #endif
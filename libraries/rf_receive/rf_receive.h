@@ -34,7 +34,10 @@
 #endif
 
 #ifndef REPTIME
-#  define REPTIME      38
+#  define REPTIME      38               // XR, in 1/125 sec
+#endif
+#ifndef REP_CACHE
+#  define REP_CACHE    16               // reported messages, RAM: 28b * n
 #endif
 
 /* public prototypes */
@@ -45,6 +48,17 @@
 #  define MAXMSG 20               // EMEM messages
 #endif
 
+#define RCV_BUCKETS_MIN  2
+#define RCV_BUCKETS_MAX 64            // XB: heap above RCV_BUCKETS
+#define RCV_TYPES       16            // XS: protocol counters
+
+#ifdef HAS_RF_EDGE_RING
+#  define EDGE_SILENCE 0xFFFF           // timer1 expired, no edge
+#  if (HAS_RF_EDGE_RING & (HAS_RF_EDGE_RING-1))
+#    error HAS_RF_EDGE_RING must be a power of two
+#  endif
+#endif
+
 #ifdef HAS_IT
 #  ifndef LONG_PULSE
 #    define LONG_PULSE
@@ -59,6 +73,7 @@
 
 class RfReceiveClass {
 public:
+	uint8_t pending(void) { return bucket_nrused; } // buckets to analyze
 	void set_txreport(char *in);
 	void set_txrestore(void);
 	void tx_init(void);
@@ -70,10 +85,33 @@ public:
 	void RfAnalyze_Task(void);
 	void IsrHandler();
 	void IsrTimer1(void);
+	void set_buckets(uint8_t n);
+	void buckets_func(char *in);
+	void stats_func(char *in);
+	uint8_t stamp;                     // XT
+	void stamp_display(uint32_t us);
 private:
+	void stamp_func(char *in);
+#ifdef HAS_RF_EDGE_RING
+	// GDO2 edges queued by the ISRs, classified in RfAnalyze_Task
+	uint16_t edge_ring[HAS_RF_EDGE_RING];
+	uint32_t edge_us[HAS_RF_EDGE_RING];
+	uint16_t edge_in;                  // written by the ISRs only
+	uint16_t edge_out;                 // written by RfAnalyze_Task only
+	uint8_t edge_gap, edge_t1_armed;
+	uint32_t edge_time, edge_t1;       // us, classifier time base
+	uint32_t edge_overflow;            // edges dropped, ring full
+	uint32_t edge_reported;            // edge_overflow at the last EOVF
+	void edge_push(uint16_t e, uint32_t us);
+	void edge_drain(void);
+#endif
+	void restart_timer(void);
+	uint32_t edge_now;                 // micros() of the classified edge
+	void classify_edge(uint32_t t, uint8_t level);
+	void silence_timeout(void);
 	typedef struct  {
 	  uint8_t *data;
-	  uint8_t byte, bit;
+	  uint8_t pos;                  // bit, 0 is the MSB of data[0]
 	} input_t;
 
 	typedef struct {
@@ -91,23 +129,46 @@ private:
 	// One bucket to collect the "raw" bits
 	typedef struct {
 	  uint8_t state, byteidx, sync, bitidx; 
-	  uint8_t data[MAXMSG];         // contains parity and checksum, but no sync
+	  uint8_t data[MAXMSG+2];       // contains parity and checksum, but no sync
+	                                // +2: read ahead of getword()
 	  wave_t zero, one; 
+	  uint8_t lasthigh;             // last pulse, it has no rising edge
+	  uint32_t time;                // micros() at the sync, XT
+	  uint32_t eop;                 // micros() at the silence, XL
 	} bucket_t;
-    bucket_t bucket_array[RCV_BUCKETS];
+	bucket_t bucket_pool[RCV_BUCKETS];  // default pool, heap if larger
+	bucket_t *bucket_array;
+	uint8_t bucket_cnt;
 
 	uint8_t bucket_in;                 // Pointer to the in(terrupt) queue
 	uint8_t bucket_out;                // Pointer to the out (analyze) queue
 	uint8_t bucket_nrused;             // Number of unprocessed buckets
 	uint8_t oby, obuf[MAXMSG], nibble; // parity-stripped output
-	uint8_t roby, robuf[MAXMSG];       // for Repeat check: buffer and time
-	uint32_t reptime;
+	// Repeat check: recently reported messages, indexed by a hash of type
+	// and data
+	typedef struct {
+	  uint32_t time;                   // CLOCK.ticks of the last reception
+	  uint8_t type, len;
+	  uint8_t data[MAXMSG];
+	} rep_entry_t;
+	rep_entry_t rep_cache[REP_CACHE];
+	uint8_t reptime;
+	uint8_t rep_check(uint8_t type);
+	void reptime_func(char *in);
 #ifdef LONG_PULSE
 	uint16_t hightime, lowtime;
 #else
 	uint8_t hightime, lowtime;
 #endif
 
+	// XS statistics
+	uint8_t stat_hwm;                  // max. buckets in use
+	uint32_t stat_overflow;            // messages dropped, all buckets full
+	uint32_t stat_false;               // too short to analyze
+	uint32_t stat_unknown;             // analyzed, no protocol matched
+	uint32_t stat_repeat;              // repeats not reported
+	uint32_t stat_type[RCV_TYPES];     // decoded, per rcv_types entry
+
 uint32_t silence;
 uint32_t overflow;
 uint32_t pulseTooShort;
@@ -117,7 +178,7 @@ uint32_t pulseTooLong;
 
 	void addbit(bucket_t *b, uint8_t bit);
 	void delbit(bucket_t *b);
-	uint8_t getbit(input_t *in);
+	uint16_t getword(input_t *in, uint8_t nbits);
 	uint8_t getbits(input_t* in, uint8_t nbits, uint8_t msb);
 
 	uint8_t wave_equals(wave_t *a, uint8_t htime, uint8_t ltime, uint8_t state);
@@ -141,6 +202,13 @@ uint32_t pulseTooLong;
 #endif
 #ifdef HAS_FTZ
 	uint8_t analyze_ftz(bucket_t *b);
+#endif
+	uint8_t decode(bucket_t *b);
+	uint8_t decode_fs20(bucket_t *b);
+	uint8_t decode_em(bucket_t *b);
+	uint8_t decode_ks300(bucket_t *b);
+#ifdef HAS_HOERMANN
+	uint8_t decode_hrm(bucket_t *b);
 #endif
 	void checkForRepeatedPackage(uint8_t *datatype, bucket_t *b);
 	void reset_input(void);
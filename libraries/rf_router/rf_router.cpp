@@ -109,6 +109,7 @@ void RfRouterClass::setlow(uint16_t dur) {
 // Duration is 15ms, more than one tick!
 void RfRouterClass::ping(void)
 {
+  RfSend.tx_wait();            // a slow rf message is still being sent
   CC1100.set_ccon();           // 1.7ms
   CC1100.ccTX();               // 4.8ms
 
@@ -20,6 +20,7 @@
 #include "display.h"
 #include "fncollection.h"
 #include "fht.h"
+#include "clock.h"
 
 #ifdef HAS_DMX
 #  include "dmx.h"
@@ -92,6 +93,24 @@ void RfSendClass::send_bit(uint8_t bit, uint8_t edge = 0)
 #endif
 }
 
+#ifdef HAS_RF_TX_TIMER
+// send_bit for the pulse list
+void RfSendClass::tx_bit(uint8_t bit, uint8_t edge)
+{
+  if (edge) {
+    tx_hold(onelow);
+    tx_level = !bit;
+    tx_hold(onelow);
+    tx_level = bit;
+  } else {
+    tx_level = 1;
+    tx_hold(bit ? TMUL(onehigh) : TMUL(zerohigh));
+    tx_level = 0;
+    tx_hold(bit ? TMUL(onelow) : TMUL(zerolow));
+  }
+}
+#endif
+
 #else
 
 #  define MAX_SNDMSG 6    // FS20: 4 or 5 + CRC, FHT: 5+CRC
@@ -114,12 +133,290 @@ void RfSendClass::send_bit(uint8_t bit, uint8_t edge = 0)
 #endif
 }
 
+#ifdef HAS_RF_TX_TIMER
+void RfSendClass::tx_bit(uint8_t bit, uint8_t edge)
+{
+  tx_level = 1;
+  tx_hold(bit ? FS20_ONE : FS20_ZERO);
+  tx_level = 0;
+  tx_hold(bit ? FS20_ONE : FS20_ZERO);
+}
+#endif
+
+#endif
+
+#ifdef HAS_RF_TX_TIMER
+//////////////////////////////////////////////////////////////////////
+// Non-blocking transmit: sendraw compiles one repeat of the message into
+// tx_pulse (GDO0 level and duration in us), IsrTimer1 plays it out with
+// timer1, which is free as the receiver is off while sending.
+
+// Add us at tx_level to the pulse list
+void RfSendClass::tx_hold(uint32_t us)
+{
+  uint16_t level = tx_level ? 0x8000 : 0;
+
+  while(us) {
+    uint16_t d, *p = tx_pulse + tx_len - 1;
+    if(tx_len && (*p & 0x8000) == level && (*p & 0x7fff) < 0x7fff) {
+      d = 0x7fff - (*p & 0x7fff);       // same level: longer pulse
+      if(d > us)
+        d = us;
+      *p += d;
+    } else if(tx_len < TX_PULSES) {
+      d = us > 0x7fff ? 0x7fff : us;
+      tx_pulse[tx_len++] = level | d;
+    } else {
+      tx_ovf = 1;
+      return;
+    }
+    us -= d;
+  }
+}
+
+void ICACHE_RAM_ATTR RfSendClass::IsrTimer1(void)
+{
+  if(tx_pos == tx_len) {
+    if(--tx_repeat == 0) {
+      digitalWrite(CC1100_OUT_PIN, tx_end);
+      tx_state = TX_DONE;
+      timer1_write(OCR1A);              // the receivers silence timer
+      return;
+    }
+    tx_pos = 0;
+  }
+  uint16_t p = tx_pulse[tx_pos++];
+  digitalWrite(CC1100_OUT_PIN, p >> 15);
+  timer1_write((uint32_t)(p & 0x7fff) * 5); // 5 ticks per us
+}
+
+// Back to RX when the message is sent
+void RfSendClass::tx_done(void)
+{
+  if(tx_report) {                               // Enable RX
+    CC1100.ccRX();
+  } else {
+    CC1100.ccStrobe(CC1100_SIDLE);
+  }
+#ifdef HAS_MORITZ
+  if(tx_moritz)
+    Moritz.init();
+#endif
+  LED_OFF();
+  tx_seq_done = tx_seq;
+  tx_state = TX_IDLE;
+}
+
+void RfSendClass::task(void)
+{
+  if(tx_state == TX_DONE)
+    tx_done();
+  tx_next();
+}
+
+// Wait until the message on air is sent, e.g. before using the CC1101
+void RfSendClass::tx_wait(void)
+{
+  while(tx_state != TX_IDLE) {
+    MYDELAY.my_delay_ms(1);
+    if(tx_state == TX_DONE)
+      tx_done();
+  }
+}
+
+//////////////////////////////////////////////////////////////////////
+// Transmit queue: sendraw only queues the message, task() starts the
+// most urgent one (priority, then deadline) as soon as credit_10ms
+// covers it. Messages waiting past their deadline are dropped.
+void RfSendClass::txq_remove(uint8_t i)
+{
+  txq_n--;
+  memmove(txq+i, txq+i+1, (txq_n-i) * sizeof(tx_msg_t));
+}
+
+void RfSendClass::tx_next(void)
+{
+  uint8_t best = TXQ_SIZE;
+
+  if(tx_state != TX_IDLE)
+    return;
+  for(uint8_t i = 0; i < txq_n; ) {
+    tx_msg_t *m = txq+i;
+    if((int32_t)(CLOCK.ticks - m->deadline) > 0) {
+      txq_remove(i);
+      tx_dropped++;
+      continue;
+    }
+    if(best == TXQ_SIZE || m->prio > txq[best].prio ||
+       (m->prio == txq[best].prio &&
+        (int32_t)(m->deadline - txq[best].deadline) < 0))
+      best = i;
+    i++;
+  }
+  if(best == TXQ_SIZE || credit_10ms < txq[best].cost)
+    return;
+
+  tx_msg_t m = txq[best];
+  txq_remove(best);
+  tx_start(&m);
+}
+
+// Where the message queued as seq is: TXS_QUEUED, _SENT or _LOST
+uint8_t RfSendClass::tx_status(uint16_t seq)
+{
+  if(seq == tx_seq_done)
+    return TXS_SENT;
+  if(tx_state != TX_IDLE && seq == tx_seq)
+    return TXS_QUEUED;
+  for(uint8_t i = 0; i < txq_n; i++)
+    if(txq[i].seq == seq)
+      return TXS_QUEUED;
+  return TXS_LOST;
+}
+
+// XQ: queue length, seconds until the credit covers the queue
+void RfSendClass::queue_func(char *in)
+{
+  uint16_t wait = 0;
+  for(uint8_t i = 0; i < txq_n; i++)
+    wait += txq[i].cost;
+  wait = wait > credit_10ms ? wait - credit_10ms : 0;
+
+  DS("queued:");   DU(txq_n, 0);
+  DS(" wait:");    DU(wait, 0);
+  DS(" credit:");  DU(credit_10ms, 0);
+  DS(" dropped:"); DU(tx_dropped, 0);
+  DS(" rejected:");DU(tx_rejected, 0);
+  DNL();
+
+  if(in[2] == 'r')
+    tx_dropped = tx_rejected = 0;
+}
+
+// Compile one repeat into the pulse list and start playing it
+void RfSendClass::tx_start(tx_msg_t *m)
+{
+  uint8_t *msg = m->msg, nbyte = m->nbyte, bitoff = m->bitoff;
+  uint8_t sync = m->sync, edge = m->edge;
+  int8_t i, j;
+
+#if defined(HAS_RAWSEND) || defined(HAS_HOERMANN_SEND)
+  zerohigh = m->zerohigh;
+  zerolow  = m->zerolow;
+  onehigh  = m->onehigh;
+  onelow   = m->onelow;
+#endif
+  tx_len = tx_ovf = tx_level = 0;
+  if(m->addH>0 || m->addL>0) {
+    tx_level = 1;
+    tx_hold(TMUL(m->addH));
+    tx_level = 0;
+    tx_hold(TMUL(m->addL));
+  }
+  for(i = 0; i < sync; i++)
+    tx_bit(0, 0);
+  if(sync)
+    tx_bit(1, 0);
+  for(j = 0; j < nbyte; j++)
+    for(i = 7; i >= 0; i--)
+      tx_bit(msg[j] & _BV(i), edge);
+  for(i = 7; i > bitoff; i--)
+    tx_bit(msg[nbyte] & _BV(i), edge);
+  tx_hold((uint32_t)m->pause * 1000);
+  tx_end = tx_level;
+  if(tx_ovf) {
+    DS_P(PSTR("TXOVF\r\n"));
+    return;
+  }
+  if(!tx_len)
+    return;
+
+  credit_10ms -= m->cost;
+  tx_seq = m->seq;
+  LED_ON();
+
+#ifdef HAS_MORITZ
+  tx_moritz = 0;
+  if(Moritz.on()) {
+    tx_moritz = 1;
+    Moritz.on(0);
+    RfReceive.set_txreport("21");
+  }
+#endif
+  if(tx_report & REP_BITS) {
+    DC('s');
+    DU(edge,        2);
+    DU(TMUL(zerohigh), 5);
+    DU(TMUL(zerolow), 5);
+    DU(TMUL(onehigh), 5);
+    DU(TMUL(onelow), 5);
+    DU(sync,         3);
+    DU(nbyte,      3);
+    DU(7-bitoff,     2);
+    DC(' ');
+
+    for(uint8_t i=0; i < nbyte; i++)
+       DH2(msg[i]);
+    if(bitoff != 7)
+       DH2(msg[nbyte]);
+    DNL();
+  }
+
+  if(!cc_on)
+    CC1100.set_ccon();
+  CC1100.ccTX();                                       // Enable TX 
+  tx_repeat = m->repeat;
+  tx_pos = 0;
+  noInterrupts();
+  tx_state = TX_RUN;
+  IsrTimer1();                                  // first pulse
+  interrupts();
+}
 #endif
 
 // msg is with parity/checksum already added
 void RfSendClass::sendraw(uint8_t *msg, uint8_t sync, uint8_t nbyte, uint8_t bitoff,
-                uint8_t repeat, uint8_t pause, uint8_t edge, uint8_t addH, uint8_t addL)
+                uint8_t repeat, uint8_t pause, uint8_t edge, uint8_t addH, uint8_t addL,
+                uint8_t prio)
 {
+#ifdef HAS_RF_TX_TIMER
+  // 12*800+1200+nbyte*(8*1000)+(bits*1000)+800+10000 
+  // message len is < (nbyte+2)*repeat in 10ms units.
+  uint16_t sum = (nbyte+2)*repeat + addH + addL;
+  uint8_t len = nbyte + (bitoff != 7);
+  txq_seq = 0;
+  if(len > sizeof(txq[0].msg))
+    return;
+  if(sum > MAX_CREDIT || txq_n == TXQ_SIZE) {
+    tx_rejected++;
+    DS_P(PSTR("LOVF\r\n"));
+    return;
+  }
+
+  tx_msg_t *m = txq + txq_n++;
+  m->prio = prio;
+  m->deadline = CLOCK.ticks + (prio == TXQ_HIGH ? TXQ_WAIT_HIGH : TXQ_WAIT);
+  m->cost = sum;
+  if(!++txq_next)                       // 0 is rejected
+    txq_next = 1;
+  m->seq = txq_seq = txq_next;
+  memcpy(m->msg, msg, len);
+  m->sync = sync;
+  m->nbyte = nbyte;
+  m->bitoff = bitoff;
+  m->repeat = repeat;
+  m->pause = pause;
+  m->edge = edge;
+  m->addH = addH;
+  m->addL = addL;
+#if defined(HAS_RAWSEND) || defined(HAS_HOERMANN_SEND)
+  m->zerohigh = zerohigh;
+  m->zerolow  = zerolow;
+  m->onehigh  = onehigh;
+  m->onelow   = onelow;
+#endif
+  tx_next();
+#else
   // 12*800+1200+nbyte*(8*1000)+(bits*1000)+800+10000 
   // message len is < (nbyte+2)*repeat in 10ms units.
   int8_t i, j, sum = (nbyte+2)*repeat + addH + addL;
@@ -213,6 +510,7 @@ void RfSendClass::sendraw(uint8_t *msg, uint8_t sync, uint8_t nbyte, uint8_t bit
     Moritz.init();
 #endif
   LED_OFF();
+#endif
 }
 
 int RfSendClass::abit(uint8_t b, uint8_t *obuf, uint8_t *obyp, uint8_t obi)
@@ -231,7 +529,7 @@ int RfSendClass::abit(uint8_t b, uint8_t *obuf, uint8_t *obyp, uint8_t obi)
 }
 
 void RfSendClass::addParityAndSendData(uint8_t *hb, uint8_t hblen,
-                uint8_t startcs, uint8_t repeat)
+                uint8_t startcs, uint8_t repeat, uint8_t prio)
 {
   uint8_t iby, obuf[MAX_SNDRAW], oby;
   int8_t ibi, obi;
@@ -258,14 +556,15 @@ void RfSendClass::addParityAndSendData(uint8_t *hb, uint8_t hblen,
   zerohigh = zerolow = TDIV(FS20_ZERO);
   onehigh = onelow = TDIV(FS20_ONE);
 #endif
-  sendraw(obuf, 12, oby, obi, repeat, FS20_PAUSE, 0, 0, 0);
+  sendraw(obuf, 12, oby, obi, repeat, FS20_PAUSE, 0, 0, 0, prio);
 }
 
-void RfSendClass::addParityAndSend(char *in, uint8_t startcs, uint8_t repeat)
+void RfSendClass::addParityAndSend(char *in, uint8_t startcs, uint8_t repeat,
+                uint8_t prio)
 {
   uint8_t hb[MAX_SNDMSG], hblen;
   hblen = STRINGFUNC.fromhex(in+1, hb, MAX_SNDMSG-1);
-  addParityAndSendData(hb, hblen, startcs, repeat);
+  addParityAndSendData(hb, hblen, startcs, repeat, prio);
 }
 
 void RfSendClass::fs20send(char *in)
@@ -5,6 +5,36 @@
 
 #define MAX_CREDIT 3600// 900       // max 9 seconds burst / 25% of the hourly budget
 
+#ifdef HAS_RF_TX_TIMER
+#  ifndef TX_PULSES
+#    define TX_PULSES 256               // pulse list of one repeat, RAM: 2b * n
+#  endif
+#  define TX_IDLE 0
+#  define TX_RUN  1                     // timer1 plays out the pulse list
+#  define TX_DONE 2                     // sent, task() switches back to RX
+#  ifndef TXQ_SIZE
+#    define TXQ_SIZE 16                 // queued messages, RAM: 38b * n
+#  endif
+#  define TXQ_WAIT      (600*125)       // ticks a command may wait for credit
+#  define TXQ_WAIT_HIGH  (10*125)       // FHT, stale after that
+#  define TXS_QUEUED 0                  // tx_status(): queued or on air
+#  define TXS_SENT   1
+#  define TXS_LOST   2                  // rejected, dropped or TXOVF
+
+typedef struct {
+  uint32_t deadline;                    // CLOCK.ticks
+  uint16_t cost;                        // credit_10ms
+  uint16_t seq;                         // RfSend.txq_seq when queued
+  uint8_t prio;
+  uint8_t msg[16];
+  uint8_t sync, nbyte, bitoff, repeat, pause, edge, addH, addL;
+  uint8_t zerohigh, zerolow, onehigh, onelow;
+} tx_msg_t;
+#endif
+
+#define TXQ_NORMAL 0                    // commands
+#define TXQ_HIGH   1                    // FHT, timed by the protocol
+
 class RfSendClass {
 public:
 	/* public prototypes */
@@ -16,17 +46,46 @@ public:
 	void ks_send(char *in);
 	void ur_send(char *in);
     void hm_send(char *in);
-	void addParityAndSend(char *in, uint8_t startcs, uint8_t repeat);
+	void addParityAndSend(char *in, uint8_t startcs, uint8_t repeat,
+							uint8_t prio = TXQ_NORMAL);
 	void addParityAndSendData(uint8_t *hb, uint8_t hblen,
-							uint8_t startcs, uint8_t repeat);
+							uint8_t startcs, uint8_t repeat,
+							uint8_t prio = TXQ_NORMAL);
 
 
     uint16_t credit_10ms;
+#ifdef HAS_RF_TX_TIMER
+	volatile uint8_t tx_state;
+	void task(void);
+	void tx_wait(void);
+	void IsrTimer1(void);
+	void queue_func(char *in);
+	uint16_t txq_seq;                   // of the last queued message, 0: rejected
+	uint8_t tx_status(uint16_t seq);    // TXS_*
+#else
+	void tx_wait(void) {}
+#endif
 private:
 	void send_bit(uint8_t bit, uint8_t edge);
 	void sendraw(uint8_t *msg, uint8_t sync, uint8_t nbyte, uint8_t bitoff, 
-                uint8_t repeat, uint8_t pause, uint8_t edge, uint8_t addH, uint8_t addL);
+                uint8_t repeat, uint8_t pause, uint8_t edge, uint8_t addH, uint8_t addL,
+                uint8_t prio = TXQ_NORMAL);
 	int abit(uint8_t b, uint8_t *obuf, uint8_t *obyp, uint8_t obi);
+#ifdef HAS_RF_TX_TIMER
+	void tx_hold(uint32_t us);
+	void tx_bit(uint8_t bit, uint8_t edge);
+	uint16_t tx_pulse[TX_PULSES];       // level << 15 | us
+	uint16_t tx_len, tx_pos;
+	uint8_t tx_level, tx_end, tx_ovf, tx_repeat, tx_moritz;
+	tx_msg_t txq[TXQ_SIZE];
+	uint8_t txq_n;
+	uint16_t tx_dropped, tx_rejected;
+	uint16_t txq_next, tx_seq, tx_seq_done;
+	void tx_done(void);
+	void tx_next(void);
+	void tx_start(tx_msg_t *m);
+	void txq_remove(uint8_t i);
+#endif
 
 
 };
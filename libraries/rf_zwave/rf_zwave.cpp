@@ -0,0 +1,633 @@
+#include "board.h"
+#ifdef HAS_ZWAVE
+#include <string.h>
+#include "cc1100.h"
+#include "delay.h"
+#include "display.h"
+#include "stringfunc.h"
+#include "rf_receive.h"
+#include "rf_pktq.h"
+#ifdef HAS_RF_FRAME
+#  include "rf_frame.h"
+#endif
+#include "rf_zwave.h"
+
+// See also: ZAD-12837-1, ITU-G.9959
+/*
+bWidth:
+26000000/(8*(4+0)*2^3) = 101.5   # c -> better reception
+26000000/(8*(4+1)*2^1) = 325.0   # 5
+26000000/(8*(4+0)*2^1) = 406.2   # 4
+
+dRate:
+26000000/(2^28)*(256+147)*(2^10) = 39970
+26000000/(2^28)*(256+248)*(2^11) = 99975
+26000000/(2^28)*(256+131)*(2^ 9) = 19192
+
+deviation:
+26000000/(2^17)*(8+5)*(2^3) = 20629.8
+26000000/(2^17)*(8+1)*(2^4) = 28564.4
+
+freq:
+26000000/(2^16)*0x216666 = 868399.841
+26000000/(2^16)*0x2174ad = 869849.884
+26000000/(2^16)*0x216699 = 868420.074
+
+Msg length in bits for 8 bytes payload:
+9600: 10+2+9+8+1=30 bytes -> 25ms
+40k : 10+2+9+8+1=30 bytes ->  6ms
+100k: 40+2+9+8+2=61 bytes -> 4.9ms
+
+*/
+
+const uint8_t PROGMEM ZWAVE_CFG_9600[] = {
+  CC1100_IOCFG2,    0x00, // 00 GDO2 pin config:                  00:FIFOTHR
+  CC1100_IOCFG0,    0x2e, // 02 GDO0 pin config:                  2e:three state
+  CC1100_FIFOTHR,   0x02, // 03 FIFO Threshhold                   02:RX:12, TX:53
+  CC1100_SYNC1,     0x55, // 04 Sync word, high byte
+  CC1100_SYNC0,     0xf0, // 05 Sync word, low byte
+  CC1100_PKTLEN,    0xff, // 06 Packet length
+  CC1100_PKTCTRL1,  0x00, // 07 Packet automation control         00:no crc/addr
+  CC1100_PKTCTRL0,  0x00, // 08 Packet automation control         00:fixlen,fifo
+  CC1100_FSCTRL1,   0x06, // 0B Frequency synthesizer control
+
+  CC1100_FREQ2,     0x21, // 0D Frequency control word, high byte 868.42MHz
+  CC1100_FREQ1,     0x66, // 0E Frequency control word, middle byte
+  CC1100_FREQ0,     0x99, // 0F Frequency control word, low byte
+  CC1100_MDMCFG4,   0x59, // 10 Modem configuration               bW 325kHz
+  CC1100_MDMCFG3,   0x83, // 11 Modem configuration               dr 19200
+  CC1100_MDMCFG2,   0x1e, // 12 Modem configuration    Manchester/G-FSK/16sync
+  CC1100_MDMCFG1,   0x52, // 13 Modem configuration               preamble 12
+  CC1100_DEVIATN,   0x35, // 15 Modem deviation setting           dev:21kHz
+
+  CC1100_MCSM0,     0x18, // 18 Main Radio Cntrl State Machine config
+  CC1100_FOCCFG,    0x16, // 19 Frequency Offset Compensation config
+  CC1100_AGCCTRL2,  0x03, // 1B AGC control
+  CC1100_FSCAL3,    0xe9, // 23 Frequency synthesizer calibration
+  CC1100_FSCAL2,    0x2a, // 24 Frequency synthesizer calibration
+  CC1100_FSCAL1,    0x00, // 25 Frequency synthesizer calibration
+  CC1100_FSCAL0,    0x1f, // 26 Frequency synthesizer calibration
+  CC1100_PATABLE,   0x50  // 3E
+};
+
+const uint8_t PROGMEM ZWAVE_CFG_40k[] = {
+  CC1100_IOCFG2,    0x00, // 00 GDO2 pin config:                  00:FIFOTHR
+  CC1100_IOCFG0,    0x2e, // 02 GDO0 pin config:                  2e:three state
+  CC1100_FIFOTHR,   0x02, // 03 FIFO Threshhold                   02:RX:12, TX:53
+  CC1100_SYNC1,     0xaa, // 04 Sync word, high byte
+  CC1100_SYNC0,     0x0f, // 05 Sync word, low byte               inverted
+  CC1100_PKTLEN,    0xff, // 06 Packet length
+  CC1100_PKTCTRL1,  0x00, // 07 Packet automation control         00:no crc/addr
+  CC1100_PKTCTRL0,  0x00, // 08 Packet automation control         00:fixlen,fifo
+  CC1100_FSCTRL1,   0x06, // 0B Frequency synthesizer control
+
+  CC1100_FREQ2,     0x21, // 0D Frequency control word, high byte 868.4MHz
+  CC1100_FREQ1,     0x66, // 0E Frequency control word, middle byte
+  CC1100_FREQ0,     0x66, // 0F Frequency control word, low byte
+  CC1100_MDMCFG4,   0xca, // 10 Modem configuration               bW 101kHz
+  CC1100_MDMCFG3,   0x93, // 11 Modem configuration               dr 40k
+  CC1100_MDMCFG2,   0x06, // 12 Modem configuration               2-FSK/16sync
+  CC1100_MDMCFG1,   0x52, // 13 Modem configuration               preamble 12
+  CC1100_DEVIATN,   0x35, // 15 Modem deviation setting           dev:21kHz
+
+  CC1100_MCSM0,     0x18, // 18 Main Radio Cntrl State Machine config
+  CC1100_FOCCFG,    0x16, // 19 Frequency Offset Compensation config
+  CC1100_AGCCTRL2,  0x03, // 1B AGC control
+  CC1100_FSCAL3,    0xe9, // 23 Frequency synthesizer calibration
+  CC1100_FSCAL2,    0x2a, // 24 Frequency synthesizer calibration
+  CC1100_FSCAL1,    0x00, // 25 Frequency synthesizer calibration
+  CC1100_FSCAL0,    0x1f, // 26 Frequency synthesizer calibration
+  CC1100_PATABLE,   0x50  // 3E
+};
+
+const uint8_t PROGMEM ZWAVE_CFG_100k[] = {
+  CC1100_IOCFG2,    0x00, // 00 GDO2 pin config:                  00:FIFOTHR
+  CC1100_IOCFG0,    0x2e, // 02 GDO0 pin config:                  2e:three state
+  CC1100_FIFOTHR,   0x02, // 03 FIFO Threshhold                   02:RX:12, TX:53
+  CC1100_SYNC1,     0xaa, // 04 Sync word, high byte
+  CC1100_SYNC0,     0x0f, // 05 Sync word, low byte               inverted
+  CC1100_PKTLEN,    0xff, // 06 Packet length
+  CC1100_PKTCTRL1,  0x00, // 07 Packet automation control         00:no crc/addr
+  CC1100_PKTCTRL0,  0x00, // 08 Packet automation control         00:fixlen,fifo
+  CC1100_FSCTRL1,   0x06, // 0B Frequency synthesizer control
+
+  CC1100_FREQ2,     0x21, // 0D Frequency control word, high byte 869.85 MHz
+  CC1100_FREQ1,     0x74, // 0E
+  CC1100_FREQ0,     0xAD, // 0F
+  CC1100_MDMCFG4,   0x4b, // 10 Modem configuration               bW 406kHz
+  CC1100_MDMCFG3,   0xf8, // 11 Modem configuration               dr 100k
+  CC1100_MDMCFG2,   0x16, // 12 Modem configuration               GFSK/16sync
+  CC1100_MDMCFG1,   0x72, // 13 Modem configuration               24 preamble
+  CC1100_DEVIATN,   0x41, // 15 Modem deviation setting           dev:28 kHz
+
+  CC1100_MCSM0,     0x18, // 18 Main Radio Cntrl State Machine config
+  CC1100_FOCCFG,    0x16, // 19 Frequency Offset Compensation config
+  CC1100_AGCCTRL2,  0x03, // 1B AGC control
+  CC1100_FSCAL3,    0xe9, // 23 Frequency synthesizer calibration
+  CC1100_FSCAL2,    0x2a, // 24 Frequency synthesizer calibration
+  CC1100_FSCAL1,    0x00, // 25 Frequency synthesizer calibration
+  CC1100_FSCAL0,    0x1f, // 26 Frequency synthesizer calibration
+  CC1100_PATABLE,   0x50  // 3E
+};
+
+// CRC-16/CCITT (0x1021) of every byte value with an initial register of 0,
+// the register for the next byte is (crc << 8) ^ crcTab[(crc >> 8) ^ data]
+static const uint16_t PROGMEM zwave_crcTab[256] = {
+  0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+  0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+  0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+  0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+  0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+  0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+  0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+  0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+  0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+  0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+  0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+  0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+  0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+  0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+  0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+  0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+  0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+  0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+  0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+  0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+  0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+  0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+  0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+  0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+  0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+  0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+  0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+  0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+  0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+  0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+  0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+  0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0
+};
+
+static uint16_t
+zwave_ckSum_16bit(const uint8_t *msg, uint8_t len)  // 100k, start 0x1D0F
+{
+  uint16_t crc = 0x1d0f;
+
+  while(len--)
+    crc = (crc << 8) ^ pgm_read_word(&zwave_crcTab[(uint8_t)(crc >> 8) ^ *msg++]);
+  return crc;
+}
+
+static uint8_t
+zwave_ckSum_8bit(const uint8_t *msg, uint8_t len)   // 9.6k, 40k
+{
+  uint8_t cs = 0xff;
+  while(len)
+    cs ^= msg[--len];
+  return cs;
+}
+
+// (Re)start RX, waiting for the header
+void ICACHE_RAM_ATTR RfZwaveClass::listen(void)
+{
+  state = ZWAVE_OFF;
+  CC1100.ccStrobe( CC1100_SIDLE );
+  CC1100.ccStrobe( CC1100_SFRX );
+  CC1100.cc1100_writeReg( CC1100_PKTLEN, 0xff );
+  CC1100.cc1100_writeReg( CC1100_FIFOTHR, ZWAVE_FIFOTHR_HDR );
+  CC1100.cc1100_writeReg( CC1100_IOCFG2, gdo = ZWAVE_GDO_FIFO );
+  CC1100.ccStrobe( CC1100_SRX );
+  started = millis();
+  state = ZWAVE_LEN;
+}
+
+void RfZwaveClass::init(uint8_t m, uint8_t dr)
+{
+  const uint8_t *cfg;
+  uint8_t n;
+
+  mode = 0;                             // the ISR keeps off
+  state = ZWAVE_OFF;
+  tx_wait = tx_pending = 0;
+  CC1100.manualReset();                 // RfMbus off as well
+
+  if(dr == ZWAVE_9600) {
+    cfg = ZWAVE_CFG_9600; n = sizeof(ZWAVE_CFG_9600);
+  } else if(dr == ZWAVE_40k) {
+    cfg = ZWAVE_CFG_40k;  n = sizeof(ZWAVE_CFG_40k);
+  } else if(dr == ZWAVE_100k) {
+    cfg = ZWAVE_CFG_100k; n = sizeof(ZWAVE_CFG_100k);
+  } else
+    return;
+  for(uint8_t i = 0; i < n; i += 2)
+    CC1100.cc1100_writeReg( pgm_read_byte(&cfg[i]), pgm_read_byte(&cfg[i+1]) );
+
+  CC1100.ccStrobe( CC1100_SCAL );
+  MYDELAY.my_delay_ms(4);
+  CC1100.ccRX();                        // GDO2 interrupt on
+
+  CC1100.spi_busy++;
+  drate = dr;
+  mode = m;
+  listen();
+  CC1100.spi_busy--;
+}
+
+// Read n bytes from the FIFO, 40k and 100k are received inverted
+void ICACHE_RAM_ATTR RfZwaveClass::get(uint8_t *p, uint8_t n)
+{
+  RfPktq.burst(p, n);
+  if(drate != ZWAVE_9600)
+    for(uint8_t i = 0; i < n; i++)
+      p[i] ^= 0xff;
+}
+
+// At least 12 bytes are in the FIFO: HomeId, SrcId, FC, Len, DstId and
+// more. 0: not a frame we can take.
+uint8_t ICACHE_RAM_ATTR RfZwaveClass::header(zwave_rx_t *t)
+{
+  uint8_t n = RfPktq.status( CC1100_RXBYTES );
+
+  if((n & 0x80) || n < 9)
+    return 0;
+  t->us = micros();
+  started = millis();
+
+  get(t->data, --n);                    // leave a byte (CC1101 errata)
+  t->len = t->data[7];
+  if(t->len < 9 || t->len > ZWAVE_MSG)
+    return 0;
+
+  // PKTLEN is 0xff until here: frames shorter than the header threshold
+  // are complete already
+  CC1100.cc1100_writeReg( CC1100_PKTLEN, t->len );
+  left = t->len > n ? t->len - n : 0;
+  if(left > ZWAVE_FIFO)
+    CC1100.cc1100_writeReg( CC1100_FIFOTHR, ZWAVE_FIFOTHR_DATA );
+  return 1;
+}
+
+// More of the frame is in the FIFO: 0 to wait, 1 when it is complete, 2
+// when the FIFO overflowed or the packet ended short.
+uint8_t ICACHE_RAM_ATTR RfZwaveClass::data(zwave_rx_t *t)
+{
+  for(;;) {
+    uint8_t high = bit_is_set( CC1100_IN_PORT, CC1100_IN_PIN );
+    uint8_t n = RfPktq.status( CC1100_RXBYTES );
+    uint8_t *p = t->data + t->len - left;
+
+    if(n & 0x80)
+      return 2;
+    if(n >= left) {
+      get(p, left);
+      return 1;
+    }
+    if(gdo == ZWAVE_GDO_PKT)            // low: the packet has ended
+      return high ? 0 : 2;
+
+    if(n > 1) {
+      get(p, --n);                      // leave a byte (CC1101 errata)
+      left -= n;
+    }
+    if(left > ZWAVE_FIFO)
+      return 0;                         // the next FIFOTHR
+
+    // The rest fits into the FIFO: wait for the end of the packet, check
+    // again as it may have passed already
+    CC1100.cc1100_writeReg( CC1100_IOCFG2, gdo = ZWAVE_GDO_PKT );
+  }
+}
+
+// GDO2 changed: the header, the next chunk or the end of the frame is in
+// the FIFO, or our frame was sent. Called by the GDO2 ISR, or by task() if
+// the SPI was in use.
+void ICACHE_RAM_ATTR RfZwaveClass::read(void)
+{
+  uint8_t high = bit_is_set( CC1100_IN_PORT, CC1100_IN_PIN );
+  zwave_rx_t *t = &q[in & (ZWAVE_QUEUE-1)];
+  uint8_t r;
+
+  switch(state) {
+  case ZWAVE_LEN:
+    if(!high)
+      return;
+    if((uint8_t)(in - out) >= ZWAVE_QUEUE) {
+      stat_full++;
+      listen();
+      return;
+    }
+    if(!header(t)) {
+      listen();
+      return;
+    }
+    state = ZWAVE_DATA;
+    break;
+
+  case ZWAVE_DATA:
+    if(gdo == ZWAVE_GDO_FIFO ? !high : high)
+      return;
+    break;
+
+  case ZWAVE_TX:                        // GDO2: sync sent to the end
+    if(high)
+      tx_seen = 1;
+    else if(tx_seen)
+      tx_end();
+    return;
+
+  default:
+    return;
+  }
+
+  if((r = data(t))) {
+    if(r == 1) {
+      t->end = micros();
+      in++;
+    } else
+      stat_lost++;
+    listen();
+  }
+}
+
+// Send tx_buf, a reception in progress is lost. The end of the packet is
+// reported on GDO2.
+void ICACHE_RAM_ATTR RfZwaveClass::tx_start(void)
+{
+  uint8_t *m = tx_buf, n = tx_len;
+
+  state = ZWAVE_OFF;
+  CC1100.ccStrobe( CC1100_SIDLE );
+  CC1100.ccStrobe( CC1100_SFTX );
+  CC1100.cc1100_writeReg( CC1100_IOCFG2, gdo = ZWAVE_GDO_PKT );
+  if(drate == ZWAVE_9600) {
+    CC1100.cc1100_writeReg( CC1100_MDMCFG2, 0x14 );     // No preamble, no manchaster,
+    CC1100.cc1100_writeReg( CC1100_PKTLEN, 2*n+19 );    // we do all this by hand.
+  } else {
+    CC1100.cc1100_writeReg( CC1100_PKTLEN, n );
+  }
+
+  CC1100_ASSERT;
+  CC1100.cc1100_sendbyte( CC1100_WRITE_BURST | CC1100_TXFIFO );
+  if(drate == ZWAVE_9600) {
+    for(uint8_t i = 0; i < 15; i++)
+      CC1100.cc1100_sendbyte( 0x66 );   // preamble 0x55; manchester code = 0x6666
+    CC1100.cc1100_sendbyte( 0xaa );     // sync 0xf0; manchester code = 0xaa55
+    CC1100.cc1100_sendbyte( 0x55 );
+    for(uint8_t i = 0; i < n; i++) {
+      uint8_t d = m[i], c;
+      c  = (d & 0x80) ? 0x80 : 0x40;    // manchester encoding
+      c += (d & 0x40) ? 0x20 : 0x10;
+      c += (d & 0x20) ? 0x08 : 0x04;
+      c += (d & 0x10) ? 0x02 : 0x01;
+      CC1100.cc1100_sendbyte( c );
+      c  = (d & 0x08) ? 0x80 : 0x40;
+      c += (d & 0x04) ? 0x20 : 0x10;
+      c += (d & 0x02) ? 0x08 : 0x04;
+      c += (d & 0x01) ? 0x02 : 0x01;
+      CC1100.cc1100_sendbyte( c );
+    }
+    CC1100.cc1100_sendbyte( 0x00 );
+    CC1100.cc1100_sendbyte( 0x00 );
+  } else {
+    for(uint8_t i = 0; i < n; i++)
+      CC1100.cc1100_sendbyte( m[i] ^ 0xff );
+  }
+  CC1100_DEASSERT;
+
+  tx_seen = 0;
+  started = millis();
+  state = ZWAVE_TX;
+  CC1100.ccStrobe( CC1100_STX );
+}
+
+void ICACHE_RAM_ATTR RfZwaveClass::tx_end(void)
+{
+  if(drate == ZWAVE_9600)
+    CC1100.cc1100_writeReg( CC1100_MDMCFG2, 0x1e );
+  listen();
+}
+
+// timer1 expired: time for tx_buf
+uint8_t ICACHE_RAM_ATTR RfZwaveClass::timer(void)
+{
+  if(!tx_wait)
+    return 0;
+  if(CC1100.spi_busy) {                 // the task is using it
+    timer1_write(ZWAVE_SPI_WAIT * 5);
+    return 1;
+  }
+  tx_wait = 0;
+  tx_start();
+  return 1;
+}
+
+// Send buf from the timer1 ISR in us. timer1 is the SlowRF silence timer,
+// which is not used while Z-Wave is on. 0: a frame is waiting or being
+// sent, its buffer and the TX FIFO are in use.
+uint8_t RfZwaveClass::send(uint8_t *buf, uint8_t n, uint32_t us)
+{
+  noInterrupts();
+  if(tx_busy()) {
+    interrupts();
+    return 0;
+  }
+  tx_buf = buf;
+  tx_len = n;
+  tx_wait = 1;
+  timer1_write(us * 5);                 // 5 ticks per us
+  interrupts();
+  return 1;
+}
+
+// zs frame, again after ZWAVE_RETRY_MS until its ACK arrives. task()
+// sends it when an ACK is in the way.
+void RfZwaveClass::send_msg(void)
+{
+  if(!send(smsg, slen, ZWAVE_TX_NOW)) {
+    tx_pending = 1;
+    return;
+  }
+  tx_pending = 0;
+  if(smsg[5] & 0x40) {                  // ackReq
+    sent = millis();
+    if(++ack_state > 1) {
+      DC('z'); DC('r'); DH2(ack_state); DNL();
+    }
+    if(ack_state >= 3)
+      ack_state = 0;
+  }
+}
+
+uint8_t RfZwaveClass::for_me(const uint8_t *m)
+{
+  return !memcmp(m, hcid, 4) && (m[8] == hcid[4] || m[8] == 0xff);
+}
+
+void RfZwaveClass::report(zwave_rx_t *t)
+{
+  uint8_t *m = t->data, len = t->len, ok;
+
+  if(drate == ZWAVE_100k)
+    ok = zwave_ckSum_16bit(m, len-2) == ((uint16_t)m[len-2] << 8 | m[len-1]);
+  else
+    ok = zwave_ckSum_8bit(m, len-1) == m[len-1];
+  if(!ok) {
+    stat_crc++;
+    return;
+  }
+  stat_ok++;
+  if(mode == 'r' && !for_me(m))
+    return;
+
+#ifdef HAS_RF_FRAME
+  if(RfFrame.mode == FRAME_BINARY) {
+    RfFrame.send('z', m, len, 0, 0, 0, t->us);
+  } else
+#endif
+  {
+    DC('z');
+    display.hexbuf(m, len);
+    if(RfReceive.stamp)
+      RfReceive.stamp_display(t->us);
+    DNL();
+  }
+
+  if(mode != 'r')
+    return;
+  if((m[5] & 3) == 3 && ack_state)      // got ACK
+    ack_state = 0;
+
+  // ackReq, not routed. Not while a frame waits for timer1 or is sent:
+  // ack[] or the TX FIFO are in use, the sender repeats.
+  if((m[5] & 0x40) && !(m[5] & 0x80) && !tx_busy()) {
+    memcpy(ack, m, 9);
+    ack[8] = m[4];                      // src -> target
+    ack[4] = hcid[4];                   // src == ctrlId
+    ack[5] = 0x03;
+    if(drate == ZWAVE_100k) {
+      uint16_t cs;
+      ack[7] = 11;                      // Len
+      cs = zwave_ckSum_16bit(ack, 9);
+      ack[9] = cs >> 8;
+      ack[10] = cs & 0xff;
+    } else {
+      ack[7] = 10;                      // Len
+      ack[9] = zwave_ckSum_8bit(ack, 9);
+    }
+
+    // ZWAVE_ACK_US after the end of the frame, not of this task
+    int32_t us = ZWAVE_ACK_US - (int32_t)(micros() - t->end);
+    if(send(ack, ack[7], us > ZWAVE_TX_NOW ? us : ZWAVE_TX_NOW)) {
+      DC('z'); DC('a'); DH2(ack[8]); DNL();
+    }
+  }
+}
+
+void RfZwaveClass::task(void)
+{
+  if(!on())
+    return;
+
+  // GDO2 changed, and not read by the ISR
+  CC1100.spi_busy++;
+  read();
+  CC1100.spi_busy--;
+
+  if(in != out) {                       // one frame per call
+    report(&q[out & (ZWAVE_QUEUE-1)]);
+    out++;
+    return;
+  }
+
+  // A transmission whose end was missed: GDO2 changed while the SPI was
+  // in use, or did not at all. Else RX and every zs would wait for good.
+  if(state == ZWAVE_TX &&
+     (uint32_t)(millis() - started) >= ZWAVE_RX_TIMEOUT) {
+    stat_txlost++;
+    CC1100.spi_busy++;
+    tx_end();
+    CC1100.spi_busy--;
+  }
+
+  if(tx_busy())
+    return;
+  if(tx_pending ||
+     (ack_state && (uint32_t)(millis() - sent) >= ZWAVE_RETRY_MS)) {
+    send_msg();
+    return;
+  }
+
+  // Now and then: restart a frame which did not end, or a receiver which
+  // is not in RX
+  if((uint32_t)(millis() - started) < ZWAVE_RX_TIMEOUT)
+    return;
+  CC1100.spi_busy++;
+  if(state == ZWAVE_DATA) {
+    stat_lost++;
+    listen();
+  } else if(RfPktq.status( CC1100_MARCSTATE ) != MARCSTATE_RX)
+    listen();
+  else
+    started = millis();
+  CC1100.spi_busy--;
+}
+
+// zr<rate>: receive and ACK, zm<rate>: monitor, rate 9, 4 (default) or 1,
+// zs<hex>: send, zi<HomeId><CtrlNodeId>: set, zi: show, zS: statistics,
+// anything else: off
+void RfZwaveClass::func(char *in)
+{
+  if(in[1] == 'r' || in[1] == 'm') {
+    init(in[1], in[2] ? in[2] : ZWAVE_40k);
+
+  } else if(in[1] == 's') {             // with zr/zm: rate and GDO2 handling
+    if(!on())
+      return;
+    if(tx_wait && tx_buf == smsg) {     // the last zs is not in the FIFO yet
+      DS("TXOVF\r\n");
+      return;
+    }
+    tx_pending = ack_state = 0;         // smsg is overwritten
+    uint8_t n = STRINGFUNC.fromhex(in+2, smsg, ZWAVE_MSG);
+    // one TX FIFO, Manchester by hand at 9.6k
+    if(n < 9 || n > (drate == ZWAVE_9600 ? (ZWAVE_FIFO-19)/2 : ZWAVE_FIFO)) {
+      DS("LENERR\r\n");
+      return;
+    }
+    slen = n;
+    send_msg();
+
+  } else if(in[1] == 'i') {
+    if(in[2]) {
+      STRINGFUNC.fromhex(in+2, hcid, 5);
+    } else {
+      DC(mode);
+      DC(drate);
+      DC(' ');
+      DH2(hcid[0]);
+      DH2(hcid[1]);
+      DH2(hcid[2]);
+      DH2(hcid[3]);
+      DC(' ');
+      DH2(hcid[4]);
+      DNL();
+    }
+
+  } else if(in[1] == 'S') {
+    DS("ok:");     DU(stat_ok, 0);
+    DS(" crc:");   DU(stat_crc, 0);
+    DS(" full:");  DU(stat_full, 0);
+    DS(" lost:");  DU(stat_lost, 0);
+    DS(" txlost:"); DU(stat_txlost, 0);
+    DNL();
+
+  } else {
+    init(0, 0);
+
+  }
+}
+
+#if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_RF_ZWAVE)
+RfZwaveClass RfZwave;
+#endif
+
+#endif
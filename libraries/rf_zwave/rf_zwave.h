@@ -0,0 +1,91 @@
+#ifndef _RF_ZWAVE_H
+#define _RF_ZWAVE_H
+
+#include <Arduino.h>
+
+// Z-Wave (ITU G.9959) at 9.6, 40 and 100 kbit/s, see clib/rf_zwave.c for
+// the AVR original. The GDO2 ISR moves the frame from the RX FIFO into a
+// queue slot as it arrives, the task checks and reports it as z<hex>.
+// ACKs and zs frames are sent from the timer1 ISR at their time, one at a
+// time: an ACK is dropped while a frame is waiting or sent, a zs waits.
+#define ZWAVE_MSG       (8+158+2)       // 158 == aMacMaxMSDUSizeR3 (G.9959)
+#define ZWAVE_QUEUE        2            // frames, power of 2
+#define ZWAVE_ACK_US   10000            // ACK after the frame, tested with 1,5,10,15ms
+#define ZWAVE_TX_NOW      50            // us, zs
+#define ZWAVE_SPI_WAIT   100            // us, timer1 again if the SPI is in use
+#define ZWAVE_RETRY_MS    48            // zs again without ACK, 3 times
+#define ZWAVE_RX_TIMEOUT 250            // ms, longer than any frame at 9.6k
+
+#define ZWAVE_9600       '9'            // zr/zm data rates
+#define ZWAVE_40k        '4'
+#define ZWAVE_100k       '1'
+
+// GDO2: RX FIFO at or above FIFOTHR, or sync to the end of the packet
+#define ZWAVE_GDO_FIFO    0x00
+#define ZWAVE_GDO_PKT     0x06
+#define ZWAVE_FIFOTHR_HDR  0x02         // 12 bytes: the header with the length
+#define ZWAVE_FIFOTHR_DATA 0x07         // 32 bytes
+#define ZWAVE_FIFO        64            // RX and TX FIFO
+
+#define ZWAVE_OFF          0
+#define ZWAVE_LEN          1            // waiting for the header
+#define ZWAVE_DATA         2
+#define ZWAVE_TX           3
+
+typedef struct {
+	uint32_t us;                        // micros() at the header, XT
+	uint32_t end;                       // micros() at the end, for the ACK
+	uint8_t len;
+	uint8_t data[ZWAVE_MSG];
+} zwave_rx_t;
+
+class RfZwaveClass {
+public:
+	uint8_t mode;                       // 0, 'r': receive and ACK, 'm': monitor
+
+	uint8_t on(void) { return mode != 0; }
+	void off(void) { mode = 0; tx_wait = tx_pending = 0; } // the config was overwritten
+	void read(void);                    // GDO2 ISR, both edges
+	uint8_t timer(void);                // timer1 ISR, 1 if it was ours
+	void task(void);
+	void func(char *in);
+	uint8_t pending(void) { return in != out; }
+
+private:
+	zwave_rx_t q[ZWAVE_QUEUE];
+	volatile uint8_t in, out;
+	volatile uint8_t state;             // ZWAVE_OFF, _LEN, _DATA, _TX
+	volatile uint8_t tx_wait;           // timer1 runs for tx_buf
+	uint8_t tx_seen;                    // GDO2 was high in TX: sync sent
+	uint8_t tx_pending;                 // zs after the ACK in progress
+	uint8_t *tx_buf, tx_len;
+	uint8_t left;                       // bytes still to read
+	uint8_t gdo;                        // IOCFG2, ZWAVE_GDO_*
+	uint32_t started;                   // millis() at listen(), the header or TX
+	uint8_t drate;                      // ZWAVE_9600, _40k, _100k
+	uint8_t hcid[5];                    // HomeId (4byte) + CtrlNodeId (1byte)
+	uint8_t smsg[ZWAVE_MSG], slen, ack_state;
+	uint32_t sent;                      // millis() at the last zs
+	uint8_t ack[11];
+	uint16_t stat_ok, stat_crc, stat_full, stat_lost;
+	uint16_t stat_txlost;               // end of our TX missed, see task()
+
+	void init(uint8_t m, uint8_t dr);
+	void listen(void);
+	void get(uint8_t *p, uint8_t n);
+	uint8_t header(zwave_rx_t *t);
+	uint8_t data(zwave_rx_t *t);
+	void tx_start(void);
+	void tx_end(void);
+	uint8_t tx_busy(void) { return tx_wait || state == ZWAVE_TX; }
+	uint8_t send(uint8_t *buf, uint8_t n, uint32_t us);
+	void send_msg(void);
+	uint8_t for_me(const uint8_t *m);
+	void report(zwave_rx_t *t);
+};
+
+#if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_RF_ZWAVE)
+extern RfZwaveClass RfZwave;
+#endif
+
+#endif
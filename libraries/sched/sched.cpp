@@ -0,0 +1,56 @@
+#include "board.h"
+#include "sched.h"
+#ifdef HAS_PROFILE
+#  include "profile.h"
+#endif
+
+void SchedClass::add(uint8_t id, sched_fn fn, uint8_t events, uint32_t period)
+{
+  if(ntask >= SCHED_TASKS)
+    return;
+  sched_task_t *t = &task[ntask++];
+  t->fn = fn;
+  t->id = id;
+  t->events = events;
+  t->period = period;
+  t->last = micros();
+}
+
+// One pass over the tasks. Events set during the pass are seen by the next.
+void SchedClass::run(void)
+{
+  noInterrupts();
+  uint8_t ev = ready;
+  ready = 0;
+  interrupts();
+  uint32_t slice = micros();
+
+#ifdef HAS_PROFILE
+  Profile.loop();
+#endif
+  for(uint8_t i = 0; i < ntask; i++) {
+    sched_task_t *t = &task[i];
+    uint32_t now = micros();
+
+    if(t->period && now - t->last >= t->period) {
+      t->last += t->period;
+      if(now - t->last >= t->period)    // late, do not catch up
+        t->last = now;
+    } else if(!(ev & t->events) && (t->events || t->period)) {
+      continue;
+    }
+
+    t->fn();
+#ifdef HAS_PROFILE
+    Profile.task(t->id, now);
+#endif
+    if(micros() - slice >= SCHED_SLICE) {
+      yield();
+      slice = micros();
+    }
+  }
+}
+
+#if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_SCHED)
+SchedClass Sched;
+#endif
@@ -0,0 +1,46 @@
+#ifndef _SCHED_H
+#define _SCHED_H
+
+#include <Arduino.h>
+
+// Events, set by the ISRs with Sched.wake_isr() and by tasks with wake()
+#define SCHED_EV_RF    0x01             // GDO2 edge or silence
+#define SCHED_EV_TX    0x02             // timer1 while sending
+#define SCHED_EV_TICK  0x04             // CLOCK.ticks advanced
+
+#define SCHED_TASKS    24
+#define SCHED_SLICE    2000             // us, yield to the WLAN after that
+
+typedef void (*sched_fn)(void);
+
+// A task runs when one of its events is set or its period (us) is over.
+// Without events and period it runs on every pass.
+class SchedClass {
+public:
+	void add(uint8_t id, sched_fn fn, uint8_t events, uint32_t period);
+	void ICACHE_RAM_ATTR wake_isr(uint8_t events) { ready |= events; }
+	void wake(uint8_t events) {
+	  noInterrupts();
+	  ready |= events;
+	  interrupts();
+	}
+	void run(void);
+
+private:
+	typedef struct {
+	  sched_fn fn;
+	  uint8_t id;                   // PROF_*, for the profiler
+	  uint8_t events;
+	  uint32_t period, last;
+	} sched_task_t;
+
+	sched_task_t task[SCHED_TASKS];
+	uint8_t ntask;
+	volatile uint8_t ready;
+};
+
+#if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_SCHED)
+extern SchedClass Sched;
+#endif
+
+#endif
@@ -1,69 +1,121 @@
+#include <string.h>
+#include "board.h"
 #include "ttydata.h"
 #include "display.h"
+#include "fncollection.h"
+#include "stringfunc.h"
+#ifdef HAS_PROFILE
+#  include "profile.h"
+#endif
 
 //esp8266 void (*input_handle_func)(uint8_t channel);
 
 TTYdataClass::TTYdataClass() {}
 
+// Index fntab by command letter, the first entry of a letter wins
+void TTYdataClass::init(void)
+{
+  memset(fnidx, 0, sizeof(fnidx));
+  for(uint8_t idx = 0; fntab[idx].name; idx++) {
+    uint8_t n = fntab[idx].name & 0x7f;
+    if(!fnidx[n])
+      fnidx[n] = idx+1;
+  }
+  echo = FNcol.erb(EE_TTY_ECHO);
+}
+
+// buf == 0: list the commands
 uint8_t TTYdataClass::callfn(char *buf){
-  for(uint8_t idx = 0; ; idx++) {
-    uint8_t n = fntab[idx].name;
-    if(!n)
-      return 0;
-    if(buf == 0) {
+  if(buf == 0) {
+    for(uint8_t idx = 0; fntab[idx].name; idx++) {
       display.chr(' ');
-      display.chr(n);
-    } else if(buf[0] == n) {
-      void (*fn)(char *) = (void (*)(char *))fntab[idx].fn;
-      fn(buf);
-      return 1;
+      display.chr(fntab[idx].name);
     }
+    return 0;
   }
-  return 0;
+
+  uint8_t idx = fnidx[buf[0] & 0x7f];
+  if(!idx || (buf[0] & 0x80))
+    return 0;
+  idx--;
+  void (*fn)(char *) = (void (*)(char *))fntab[idx].fn;
+#ifdef HAS_PROFILE
+  uint32_t t0 = micros();
+  fn(buf);
+  Profile.command(idx, t0);
+#else
+  fn(buf);
+#endif
+  return 1;
 }
 
-void TTYdataClass::analyze_ttydata(uint8_t channel)
+// si<nn>: 00 switches the echo of the USB input off (EEPROM)
+void TTYdataClass::echo_func(char *in)
 {
-  static char cmdbuf[TTY_BUFSIZE+1];
-  static int cmdlen;
-  uint8_t ucCommand;
-  uint8_t odc;
-  
-  odc = display.channel;
-  display.channel = channel;
-    
-  while(rxBuffer.getNbytes()) {
-
-    ucCommand = rxBuffer.get();
+  if(STRINGFUNC.fromhex(in+2, &echo, 1))
+    FNcol.ewb(EE_TTY_ECHO, echo);
+  DS("si"); DH2(echo); DNL();
+}
 
+// Add one character to a command line, run the line at its end
+void TTYdataClass::line_chr(tty_line_t *l, uint8_t ucCommand)
+{
 #ifdef RPI_TTY_FIX
-    // eat RPi rubbish
-    if (ucCommand == 0xff)
-      continue;
+  // eat RPi rubbish
+  if (ucCommand == 0xff)
+    return;
 #endif
 
-    if(ucCommand == '\n' || ucCommand == '\r') {
+  if(ucCommand == '\n' || ucCommand == '\r') {
 
-      if(!cmdlen)       // empty return
-        continue;
+    if(!l->len)         // empty return
+      return;
 
-      cmdbuf[cmdlen] = 0;
-      if(!callfn(cmdbuf)) {
-        //display.string_P(PSTR("? ("));
-        DS("? (");
-        display.string(cmdbuf);
-        //display.string_P(PSTR(" is unknown) Use one of"));
-        DS(" is unknown) Use one of");
-        callfn(0);
-        display.nL();
-      }
-      cmdlen = 0;
-
-    } else {
-       if(cmdlen < sizeof(cmdbuf)-1)
-         cmdbuf[cmdlen++] = ucCommand;
+    l->buf[l->len] = 0;
+    if(l->toolong) {    // not executed cut off
+      DS("? (line too long)");
+      display.nL();
+      l->toolong = 0;
+    } else if(!callfn(l->buf)) {
+      //display.string_P(PSTR("? ("));
+      DS("? (");
+      display.string(l->buf);
+      //display.string_P(PSTR(" is unknown) Use one of"));
+      DS(" is unknown) Use one of");
+      callfn(0);
+      display.nL();
     }
+    l->len = 0;
+
+  } else {
+     if(l->len < TTY_BUFSIZE)
+       l->buf[l->len++] = ucCommand;
+     else
+       l->toolong = 1;
   }
+}
+
+// Commands from a connection with its own line, e.g. a TCP client
+void TTYdataClass::analyze_line(tty_line_t *l, const char *in, uint16_t n,
+                                uint8_t channel)
+{
+  uint8_t odc = display.channel;
+  display.channel = channel;
+  while(n--)
+    line_chr(l, *in++);
+  display.channel = odc;
+}
+
+// Commands from rxBuffer: USB and the RF router
+void TTYdataClass::analyze_ttydata(uint8_t channel)
+{
+  static tty_line_t line;
+  uint8_t odc;
+  
+  odc = display.channel;
+  display.channel = channel;
+  while(rxBuffer.getNbytes())
+    line_chr(&line, rxBuffer.get());
   display.channel = odc;
 }
 
@@ -11,17 +11,34 @@ typedef struct t_fntab{
 } t_fntab;
 extern const t_fntab fntab[];
 
+// A command line being assembled
+typedef struct {
+	char buf[TTY_BUFSIZE+1];
+	uint16_t len;
+	uint8_t toolong;                 // more than TTY_BUFSIZE, not run
+} tty_line_t;
+
 class TTYdataClass {
 public:
 	TTYdataClass();
+	void init(void);
 	void analyze_ttydata(uint8_t channel);
+	void analyze_line(tty_line_t *l, const char *in, uint16_t n,
+	                  uint8_t channel);
 	uint8_t callfn(char *buf);
+	void echo_func(char *in);
+
+	uint8_t echo;                    // echo the USB input, si (EEPROM)
 
 	void (*input_handle_func)(uint8_t channel);
 	void (*output_flush_func)(void);
 
 	RingbufferClass txBuffer;
 	RingbufferClass rxBuffer;
+
+private:
+	void line_chr(tty_line_t *l, uint8_t c);
+	uint8_t fnidx[128];              // fntab index+1 by command letter
 };
 
 #if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_TTYDATA)
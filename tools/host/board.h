@@ -0,0 +1,115 @@
+#ifndef _BOARD_H
+
+#define _BOARD_H
+
+// Host (Linux) build of the receive path, see tools/host/Makefile.
+// Mirrors the CUL_V3 feature set of libraries/board/board.h, without the
+// WLAN, OTA and packet mode (moritz, fastrf, native) parts.
+#include <Arduino.h>
+
+#define VERSION_1               1          // original CUN
+#define VERSION_2               67         // original CUN
+#define VERSION                 "1.67"
+#define VERSION_OTA             "V01-67-00" // for OTA
+#define CUL_V3
+
+// Feature definitions
+#define BOARD_ID_STR            "CUL868"
+#define BOARD_ID_USTR           L"CUL868"
+#define BOARD_ID_STR433         "CUL433"
+#define BOARD_ID_USTR433        L"CUL433"
+
+#define HAS_USB                  1
+#define HAS_FHT_80b
+#define HAS_RF_ROUTER
+#define HAS_FHT_8v
+#define HAS_FHT_TF
+#define FHTBUF_DEVICES          32
+#define FHTBUF_DEVSIZE          29
+#define RCV_BUCKETS             16
+#define HAS_RF_EDGE_RING       256
+#define HAS_RF_TX_TIMER
+#define HAS_RF_FRAME
+#define HAS_RF_LATENCY
+#define HAS_PROFILE
+#define HAS_MQTT
+#define FULL_CC1100_PA
+#define HAS_RAWSEND
+#define HAS_TX3
+#define TTY_BUFSIZE            128
+
+#define VERSION_BOARD ".culfw-esp8266.host"
+
+#define PB0 15     // CS
+#define PB1 14     // CLK
+#define PB2 13     // MOSI
+#define PB3 12     // MISO
+#define PD2 5      // GDO2
+#define PD3 4      // GDO0
+#define INT2 PD2
+
+#define EIMSK GPIE
+
+//dummy esp8266, defined by the harness
+extern unsigned char PORTB;
+extern unsigned char PORTD;
+extern unsigned char PINB;
+extern unsigned char PIND;
+extern unsigned char DDRB;
+extern unsigned char DDRD;
+extern unsigned char ISC20;
+extern unsigned char EICRA;
+extern unsigned char TIMSK1;
+extern unsigned char TIFR1;
+extern unsigned int  TCNT1;
+extern unsigned int  OCR0A;
+extern unsigned int  OCR1A;
+extern unsigned char OCF1A;
+extern unsigned char OCIE1A;
+
+// rfreplay -b: RfAnalyze_Task decodes a copy of each bucket this often first
+extern uint16_t host_analyze_repeat;
+#define RF_ANALYZE_REPEAT     host_analyze_repeat
+
+#define SPI_PORT		PORTB
+#define SPI_DDR			DDRB
+#define SPI_SS			PB0
+#define SPI_MISO		PB3
+#define SPI_MOSI		PB2
+#define SPI_SCLK		PB1
+
+#define LED_INV
+#define bit_is_set(sfr, bit) digitalRead(bit)
+#define USB_IsConnected 1
+#define __LPM(a) pgm_read_byte(a)
+
+#define CC1100_CS_DDR         SPI_DDR
+#define CC1100_CS_PORT        SPI_PORT
+#define CC1100_CS_PIN         SPI_SS
+#define CC1100_OUT_DDR        DDRD
+#define CC1100_OUT_PORT       PORTD
+#define CC1100_OUT_PIN        PD3
+#define CC1100_OUT_IN         PIND
+#define CC1100_IN_DDR         DDRD
+#define CC1100_IN_PORT        PIND
+#define CC1100_IN_PIN         PD2
+#define CC1100_IN_IN          PIND
+#define CC1100_INT            INT2
+#define CC1100_ISC            ISC20
+#define CC1100_EICR           EICRA
+#define LED_DDR               DDRE
+#define LED_PORT              PORTE
+#define LED_PIN               BUILTIN_LED
+
+#define CUL_HW_REVISION "CUL_HOST"
+
+#define MARK433_PORT            SPI_PORT
+#define MARK433_PIN             PINB
+#define MARK433_BIT             6
+#define MARK915_PORT            SPI_PORT
+#define MARK915_PIN             PINB
+#define MARK915_BIT             5
+// helper for concatenating two char[]
+#define con_cat(first, second) first second
+
+#endif // __BOARD_H__
@@ -0,0 +1,79 @@
+// Host stand-in for libraries/fncollection: the EEPROM helpers and the
+// factory defaults, without the WLAN/OTA parts the host build leaves out.
+#include <EEPROM.h>
+#include "board.h"
+#include "fncollection.h"
+#include "cc1100.h"
+#include "rf_receive.h"
+
+uint8_t led_mode = 2;
+
+FNCOLLECTIONClass::FNCOLLECTIONClass() {
+}
+
+void FNCOLLECTIONClass::ewb(uint8_t p, uint8_t v)
+{
+  ewb(p, v, true);
+}
+
+void FNCOLLECTIONClass::ewb(uint8_t p, uint8_t v, bool commit)
+{
+  EEPROM.write(p, v);
+  ewc(commit);
+}
+
+void FNCOLLECTIONClass::ewc(bool commit)
+{
+  if (commit)
+    EEPROM.commit();
+}
+
+uint8_t FNCOLLECTIONClass::erb(uint8_t p)
+{
+  return EEPROM.read(p);
+}
+
+uint16_t FNCOLLECTIONClass::erw(uint8_t p)
+{
+  return (uint16_t)EEPROM.read(p) | ((uint16_t)EEPROM.read(p+1) << 8);
+}
+
+void FNCOLLECTIONClass::eeprom_init(void)
+{
+  EEPROM.begin(0xFF);
+  if(erb(EE_MAGIC_OFFSET)   != VERSION_1 ||
+     erb(EE_MAGIC_OFFSET+1) != VERSION_2)
+       eeprom_factory_reset(0);
+  led_mode = erb(EE_LED);
+}
+
+void FNCOLLECTIONClass::eeprom_factory_reset(char *in)
+{
+  (void)in;
+  CC1100.cc_factory_reset(false);
+  ewb(EE_REQBL, 0, false);
+  ewb(EE_LED, 2, false);
+  ewb(EE_RCV_BUCKETS, RCV_BUCKETS, false);
+  ewb(EE_REPTIME, REPTIME, false);
+  ewb(EE_RF_FRAME, 0, false);
+  ewb(EE_RF_STAMP, 0, false);
+  ewb(EE_TTY_ECHO, 1, false);
+#ifdef HAS_FHT_80b
+  ewb(EE_FHTBUF_DEVS, FHTBUF_DEVICES, false);
+#endif
+#ifdef HAS_MQTT
+  for(uint8_t k = 0; k < 4; k++)
+    ewb(EE_MQTT_BROKER+k, 0, false);            // off
+  ewb(EE_MQTT_PORT, 1883 & 0xff, false);
+  ewb(EE_MQTT_PORT+1, 1883 >> 8, false);
+  ewb(EE_MQTT_QOS, 0, false);
+#endif
+  ewb(EE_FHTID, 0, false);
+  ewb(EE_FHTID+1, 0, false);
+  ewb(EE_RF_ROUTER_ID, 0x00, false);
+  ewb(EE_RF_ROUTER_ROUTER, 0x00, false);
+  ewb(EE_MAGIC_OFFSET  , VERSION_1, false);
+  ewb(EE_MAGIC_OFFSET+1, VERSION_2);
+}
+
+FNCOLLECTIONClass FNcol;
@@ -0,0 +1,415 @@
+/*
+ * mbusbench: checks the wireless M-Bus decoders of libraries/rf_mbus (and
+ * clib/mbus) against the per-byte reference they replaced (decode3outof6 /
+ * manchDecode, bitwise CRC, CRC fields found by position) and times both.
+ *
+ * Usage:
+ *   mbusbench [-b n] [telegrams...]
+ *
+ *   -b n    decode every telegram n times per mode, print the time per
+ *           telegram of the reference and of rf_mbus
+ *
+ * Telegram files hold received packets as culfw prints them, one per line:
+ * b<hex> for frame format A, bY<hex> for format B, CRC fields included;
+ * other lines are skipped. Without files, format A telegrams for every
+ * L-field from 10 to 255 and format B ones from 12 to 255 are generated.
+ * Format A telegrams are checked as T1 (3 out of 6), S1 (Manchester) and
+ * C1 format A, format B ones as C1 format B.
+ *
+ * The check decodes every telegram intact, then with one bit flipped in
+ * each byte of the over-the-air data in turn, and expects the same status
+ * and packet as the reference. Exits with 1 on a difference.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#include "mbus_defs.h"
+#include "mbus_packet.h"
+#include "manchester.h"
+#include "3outof6.h"
+#include "crc.h"
+
+#define MAX_PACKET 300
+
+typedef std::vector<uint8_t> bytes;
+
+struct telegram {
+  char mode;                            // T, S, A (C1 A) or B (C1 B)
+  bytes air;                            // as received, after the sync word
+  uint16_t size;                        // packet bytes
+};
+
+typedef uint16_t (*decoder)(uint8_t *pByte, uint8_t *pPacket, uint16_t size);
+
+// Reference: the decoders before the table CRC, one byte at a time
+
+static uint16_t crcBit(uint16_t crcReg, uint8_t crcData)
+{
+  for(uint8_t i = 0; i < 8; i++) {
+    if(((crcReg & 0x8000) >> 8) ^ (crcData & 0x80))
+      crcReg = (crcReg << 1) ^ CRC_POLYNOM;
+    else
+      crcReg = (crcReg << 1);
+    crcData <<= 1;
+  }
+  return crcReg;
+}
+
+static uint16_t refSmode(uint8_t *pByte, uint8_t *pPacket, uint16_t size)
+{
+  uint16_t remaining = size, done = 0, crc = 0;
+  uint8_t field1 = 0, field0 = 0;
+
+  while(remaining) {
+    if(manchDecode(pByte, pPacket) != MAN_DECODING_OK)
+      return PACKET_CODING_ERROR;
+    if(remaining == 2)
+      field1 = 1;
+    else if(done > 9)
+      field1 = !((done - 10) % 18);
+    if(field0) {
+      if(LO_UINT16(~crc) != *pPacket)
+        return PACKET_CRC_ERROR;
+      field0 = 0;
+      crc = 0;
+    } else if(field1) {
+      if(HI_UINT16(~crc) != *pPacket)
+        return PACKET_CRC_ERROR;
+      field0 = 1;
+      field1 = 0;
+    } else
+      crc = crcBit(crc, *pPacket);
+    remaining--;
+    done++;
+    pByte += 2;
+    pPacket++;
+  }
+  return PACKET_OK;
+}
+
+static uint16_t refTmode(uint8_t *pByte, uint8_t *pPacket, uint16_t size)
+{
+  uint16_t remaining = size, done = 0, crc = 0;
+  uint8_t field = 0;
+
+  while(remaining) {
+    if(remaining == 1) {
+      if(decode3outof6(pByte, pPacket, 1) != DECODING_3OUTOF6_OK)
+        return PACKET_CODING_ERROR;
+      remaining--;
+      if(LO_UINT16(~crc) != *pPacket)
+        return PACKET_CRC_ERROR;
+      continue;
+    }
+    if(decode3outof6(pByte, pPacket, 0) != DECODING_3OUTOF6_OK)
+      return PACKET_CODING_ERROR;
+    remaining -= 2;
+    done += 2;
+    if(remaining == 0)
+      field = 1;
+    else if(done > 10)
+      field = !((done - 12) % 18);
+    if(field) {
+      if(LO_UINT16(~crc) != pPacket[1] || HI_UINT16(~crc) != pPacket[0])
+        return PACKET_CRC_ERROR;
+      field = 0;
+      crc = 0;
+    } else if(remaining == 1) {
+      crc = crcBit(crc, pPacket[0]);
+      if(HI_UINT16(~crc) != pPacket[1])
+        return PACKET_CRC_ERROR;
+    } else {
+      crc = crcBit(crc, pPacket[0]);
+      crc = crcBit(crc, pPacket[1]);
+    }
+    pByte += 3;
+    pPacket += 2;
+  }
+  return PACKET_OK;
+}
+
+// C mode: copy, CRC fields after 10 + 16n bytes (A) or after 126 and at
+// the end (B)
+static uint16_t refCrcField(uint8_t *p, uint16_t crc)
+{
+  crc = ~crc;
+  return (p[0] << 8 | p[1]) == crc ? PACKET_OK : PACKET_CRC_ERROR;
+}
+
+static uint16_t refCmodeA(uint8_t *pByte, uint8_t *pPacket, uint16_t size)
+{
+  uint16_t crc = 0, i = 0, block = 10;
+
+  memcpy(pPacket, pByte, size);
+  while(i < size) {
+    if(size - i < block + 2)
+      block = size - i - 2;
+    for(uint16_t n = 0; n < block; n++)
+      crc = crcBit(crc, pByte[i++]);
+    if(refCrcField(pByte + i, crc) != PACKET_OK)
+      return PACKET_CRC_ERROR;
+    i += 2;
+    crc = 0;
+    block = 16;
+  }
+  return PACKET_OK;
+}
+
+static uint16_t refCmodeB(uint8_t *pByte, uint8_t *pPacket, uint16_t size)
+{
+  uint16_t crc = 0, i = 0;
+
+  memcpy(pPacket, pByte, size);
+  if(size > 128) {
+    while(i < 126)
+      crc = crcBit(crc, pByte[i++]);
+    if(refCrcField(pByte + i, crc) != PACKET_OK)
+      return PACKET_CRC_ERROR;
+    i += 2;
+    crc = 0;
+  }
+  while(i < size - 2)
+    crc = crcBit(crc, pByte[i++]);
+  return refCrcField(pByte + i, crc);
+}
+
+static decoder ref_decoder(char mode)
+{
+  switch(mode) {
+  case 'T': return refTmode;
+  case 'S': return refSmode;
+  case 'A': return refCmodeA;
+  default:  return refCmodeB;
+  }
+}
+
+static decoder new_decoder(char mode)
+{
+  switch(mode) {
+  case 'T': return decodeRXBytesTmode;
+  case 'S': return decodeRXBytesSmode;
+  case 'A': return verifyCrcBytesCmodeA;
+  default:  return verifyCrcBytesCmodeB;
+  }
+}
+
+// Telegrams
+
+static std::vector<telegram> telegrams;
+
+static void add_a(const bytes &packet)
+{
+  uint8_t buf[2 * MAX_PACKET + 2];
+  uint16_t size = packet.size();
+  telegram t;
+
+  t.size = size;
+  t.mode = 'T';
+  encodeTXBytesTmode(buf, (uint8_t *)&packet[0], size);
+  t.air.assign(buf, buf + byteSize(0, 1, size));
+  telegrams.push_back(t);
+
+  t.mode = 'S';
+  encodeTXBytesSmode(buf, (uint8_t *)&packet[0], size);
+  t.air.assign(buf + 1, buf + 1 + byteSize(1, 0, size));  // after 0x96
+  telegrams.push_back(t);
+
+  t.mode = 'A';
+  t.air = packet;
+  telegrams.push_back(t);
+}
+
+static void add_b(const bytes &packet)
+{
+  telegram t;
+  t.mode = 'B';
+  t.size = packet.size();
+  t.air = packet;
+  telegrams.push_back(t);
+}
+
+static void crc_field(bytes &p, uint16_t from, uint16_t to)
+{
+  uint16_t crc = 0;
+  for(uint16_t i = from; i < to; i++)
+    crc = crcCalc(crc, p[i]);
+  p[to] = HI_UINT16(~crc);
+  p[to + 1] = LO_UINT16(~crc);
+}
+
+static void generate(void)
+{
+  uint8_t data[256], buf[MAX_PACKET];
+
+  srand(1);
+  for(uint16_t l = 10; l < 256; l++) {
+    for(uint16_t i = 0; i < sizeof(data); i++)
+      data[i] = rand();
+    encodeTXPacket(buf, data, l - 10);
+    add_a(bytes(buf, buf + packetSize(l)));
+  }
+  for(uint16_t l = 12; l < 256; l++) {
+    if(l == 128)                        // not a valid format B length
+      continue;
+    bytes p(l + 1);
+    p[0] = l;
+    for(uint16_t i = 1; i < p.size(); i++)
+      p[i] = rand();
+    if(p.size() > 128)
+      crc_field(p, 0, 126);
+    crc_field(p, p.size() > 128 ? 128 : 0, p.size() - 2);
+    add_b(p);
+  }
+}
+
+static int load(const char *name)
+{
+  FILE *f = strcmp(name, "-") ? fopen(name, "r") : stdin;
+  char line[2 * MAX_PACKET + 8];
+
+  if(!f) {
+    perror(name);
+    return 0;
+  }
+  while(fgets(line, sizeof(line), f)) {
+    if(line[0] != 'b')
+      continue;
+    char *h = line + 1 + (line[1] == 'Y');
+    bytes p;
+    unsigned v;
+    while(p.size() < MAX_PACKET && sscanf(h, "%2x", &v) == 1) {
+      p.push_back(v);
+      h += 2;
+    }
+    if(p.size() < 3)
+      continue;
+    if(line[1] == 'Y')
+      add_b(p);
+    else
+      add_a(p);
+  }
+  if(f != stdin)
+    fclose(f);
+  return 1;
+}
+
+// Check
+
+static int compare(const telegram &t, const bytes &air, const char *what)
+{
+  uint8_t in[2 * MAX_PACKET + 2], ref[MAX_PACKET], got[MAX_PACKET];
+  uint16_t rs, gs;
+
+  memset(in, 0, sizeof(in));
+  memcpy(in, &air[0], air.size());
+  memset(ref, 0, sizeof(ref));
+  memset(got, 0, sizeof(got));
+  rs = ref_decoder(t.mode)(in, ref, t.size);
+  gs = new_decoder(t.mode)(in, got, t.size);
+  if(rs == gs && (rs != PACKET_OK || !memcmp(ref, got, t.size)))
+    return 1;
+  printf("FAIL mbus %c, %u bytes, %s: status %u, reference %u\n", t.mode,
+         t.size, what, gs, rs);
+  return 0;
+}
+
+static int check(void)
+{
+  unsigned long n[128] = {0}, bad[128] = {0}, errors[128] = {0};
+  int failed = 0;
+  char what[32];
+
+  for(size_t i = 0; i < telegrams.size(); i++) {
+    const telegram &t = telegrams[i];
+    n[(int)t.mode]++;
+    if(!compare(t, t.air, "intact"))
+      bad[(int)t.mode]++;
+    for(size_t j = 0; j < t.air.size(); j++) {
+      bytes air = t.air;
+      air[j] ^= 1 << (j % 8);
+      snprintf(what, sizeof(what), "byte %u", (unsigned)j);
+      if(!compare(t, air, what))
+        bad[(int)t.mode]++;
+      errors[(int)t.mode]++;
+    }
+  }
+  for(const char *m = "TSAB"; *m; m++) {
+    if(!n[(int)*m])
+      continue;
+    if(bad[(int)*m]) {
+      failed = 1;
+      continue;
+    }
+    printf("ok   mbus %c: %lu telegrams, %lu corrupted\n", *m,
+           n[(int)*m], errors[(int)*m]);
+  }
+  return failed;
+}
+
+// Bench
+
+static uint64_t now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static double bench_one(char mode, decoder d, int rounds)
+{
+  uint8_t packet[MAX_PACKET];
+  unsigned long count = 0;
+  uint64_t start = now_ns();
+  volatile uint16_t sink = 0;
+
+  for(int r = 0; r < rounds; r++)
+    for(size_t i = 0; i < telegrams.size(); i++)
+      if(telegrams[i].mode == mode) {
+        sink += d(&telegrams[i].air[0], packet, telegrams[i].size);
+        count++;
+      }
+  return count ? (double)(now_ns() - start) / count : 0;
+}
+
+static void bench(int rounds)
+{
+  static const char *name[] = { "T1", "S1", "C1 A", "C1 B" };
+
+  for(const char *m = "TSAB"; *m; m++) {
+    double ref = bench_one(*m, ref_decoder(*m), rounds);
+    double got = bench_one(*m, new_decoder(*m), rounds);
+    if(!ref)
+      continue;
+    printf("%-5s reference %7.1f ns, clib/mbus %7.1f ns per telegram (%.1fx)\n",
+           name[m - "TSAB"], ref, got, ref / got);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  int rounds = 0, opt;
+
+  while((opt = getopt(argc, argv, "b:")) != -1) {
+    switch(opt) {
+    case 'b': rounds = atoi(optarg); break;
+    default:
+      fprintf(stderr, "usage: %s [-b n] [telegrams...]\n", argv[0]);
+      return 1;
+    }
+  }
+  for(int i = optind; i < argc; i++)
+    if(!load(argv[i]))
+      return 1;
+  if(optind == argc)
+    generate();
+
+  if(rounds) {
+    bench(rounds);
+    return 0;
+  }
+  return check();
+}
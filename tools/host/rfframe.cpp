@@ -0,0 +1,60 @@
+/*
+ * rfframe: turns a binary report stream (XW01) back into the text lines
+ * the firmware prints with XW00, other bytes are skipped.
+ *
+ * Usage:
+ *   rfreplay -c XW01 trace | rfframe [-r] [-t]
+ *
+ *   -r      append the RSSI, as the firmware does with X21
+ *   -t      prefix every line with the frame time (ms), frames with a
+ *           reception time (XT01) get it appended as in the text
+ *
+ * Exits with 1 if a frame had a bad CRC.
+ */
+#include <stdio.h>
+#include <unistd.h>
+
+#include "board.h"
+#include "rf_frame.h"
+
+int main(int argc, char **argv)
+{
+  int rssi = 0, time = 0, opt, c;
+  static RfFrameParser parser;
+
+  while((opt = getopt(argc, argv, "rt")) != -1) {
+    switch(opt) {
+    case 'r': rssi = 1; break;
+    case 't': time = 1; break;
+    default:
+      fprintf(stderr, "usage: %s [-r] [-t] < stream\n", argv[0]);
+      return 1;
+    }
+  }
+
+  while((c = getchar()) != EOF) {
+    if(!parser.parse(c))
+      continue;
+    rf_frame_t *f = &parser.frame;
+    uint8_t n = f->len;
+    if(time && !(f->flags & FRAME_STAMP))
+      printf("%lu ", (unsigned long)f->time);
+    putchar(f->type);
+    if(n && (f->flags & FRAME_NIBBLE))
+      n--;
+    for(uint8_t i = 0; i < n; i++)
+      printf("%02X", f->data[i]);
+    if(n != f->len)
+      printf("%X", f->data[n] & 0xf);
+    if(rssi && (f->flags & FRAME_RSSI))
+      printf("%02X", f->rssi);
+    if(f->flags & FRAME_STAMP)
+      printf("@%lu.%06lu", (unsigned long)(f->time / 1000000),
+                           (unsigned long)(f->time % 1000000));
+    printf("\r\n");
+  }
+  if(parser.crc_errors)
+    fprintf(stderr, "%lu frames with bad CRC\n",
+            (unsigned long)parser.crc_errors);
+  return parser.crc_errors != 0;
+}
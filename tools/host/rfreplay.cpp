@@ -0,0 +1,381 @@
+/*
+ * rfreplay: runs the culfw receive path (libraries/rf_receive and friends)
+ * on a Linux host against recorded GDO2 pulse traces, with a virtual clock.
+ *
+ * Trace format is LIRC mode2 text, one level per line, '#' starts a comment:
+ *     pulse 400        GDO2 high for 400us
+ *     space 600        GDO2 low for 600us
+ * Consecutive lines with the same level are merged.
+ *
+ * Usage:
+ *   rfreplay [-x XX] [-l us] [-r n] [-b n] [-m ip:port] [-cC cmd] trace...
+ *                                              decode, '-' is stdin
+ *   rfreplay -g cmd...                         record what a send command
+ *                                              (F, G, K, M, T) transmits
+ *
+ *   -x XX   tx_report flags as for the X command, default 01
+ *   -c cmd  run a command before the replay, e.g. -c XB04
+ *   -C cmd  run a command after the replay, e.g. -C XS
+ *   -l us   main loop period in virtual us, default 100
+ *   -r n    replay every trace n times, summary on stderr
+ *   -b n    decode every bucket n more times, report the time per decode
+ *           on stderr
+ *   -m ip:port  publish to this MQTT broker as well (Qb), see make
+ *           mqtt-check. The broker runs in real time: before the replay
+ *           rfreplay waits until it is connected, afterwards until all is
+ *           sent, virtual time following the real one.
+ *
+ * Decoded messages go to stdout exactly as the firmware prints them.
+ * Built with RF_ANALYZE_CHAIN as rfreplay-chain, which decodes with the
+ * old try-every-decoder chain, see make bench.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#include "board.h"
+#include "host.h"
+#include "ttydata.h"
+#include "display.h"
+#include "cc1100.h"
+#include "fncollection.h"
+#include "clock.h"
+#include "led.h"
+#include "rf_receive.h"
+#include "rf_send.h"
+#include "fht.h"
+#include "rf_router.h"
+#include "rf_frame.h"
+#include "profile.h"
+#include "sched.h"
+#include "mqtt.h"
+#include "stringfunc.h"
+
+unsigned char PORTB;
+unsigned char PORTD;
+unsigned char PINB;
+unsigned char PIND;
+unsigned char DDRB;
+unsigned char DDRD;
+unsigned char ISC20;
+unsigned char EICRA;
+unsigned char TIMSK1;
+unsigned char TIFR1;
+unsigned int  TCNT1;
+unsigned int  OCR0A;
+unsigned int  OCR1A;
+unsigned char OCF1A;
+unsigned char OCIE1A;
+
+static void fhtsend_direct(char *in);
+
+const t_fntab fntab[] = {
+  { 'C', [](char *data) { CC1100.ccreg(data); } },
+  { 'F', [](char *data) { RfSend.fs20send(data); } },
+  { 'G', [](char *data) { RfSend.rawsend(data); } },
+  { 'K', [](char *data) { RfSend.ks_send(data); } },
+  { 'M', [](char *data) { RfSend.em_send(data); } },
+  { 'p', [](char *data) { Profile.func(data); } },
+  { 'Q', [](char *data) { Mqtt.func(data); } },
+  { 'T', fhtsend_direct },
+  { 't', [](char *data) { CLOCK.gettime(data); } },
+  { 'u', [](char *data) { RfRouter.func(data); } },
+  { 'X', [](char *data) { RfReceive.set_txreport(data); } },
+  { 'x', [](char *data) { CC1100.ccsetpa(data); } },
+  { 0, 0 }
+};
+
+// FHT frames are sent right away instead of waiting for a slot in the 80b
+// buffer, so -g T... records the frame a FHT device would transmit.
+static void fhtsend_direct(char *in)
+{
+  uint8_t hb[12];
+  uint8_t l = STRINGFUNC.fromhex(in+1, hb, sizeof(hb)-1);
+  if(l < 4) {
+    FHT.fhtsend(in);
+    return;
+  }
+  RfSend.addParityAndSendData(hb, l, FHT_CSUM_START, 2);
+}
+
+static void IsrHandler(void)
+{
+  Sched.wake_isr(SCHED_EV_RF);
+  if(RfSend.tx_state == TX_RUN)
+    return;
+  RfReceive.IsrHandler();
+}
+
+static void IsrTimer1(void)
+{
+  if(RfSend.tx_state == TX_RUN) {
+    RfSend.IsrTimer1();
+    Sched.wake_isr(SCHED_EV_TX);
+    return;
+  }
+  RfReceive.IsrTimer1();
+  Sched.wake_isr(SCHED_EV_RF);
+}
+
+static void setup(void)
+{
+  FILE *out = Serial.out;
+  Serial.out = 0;                       // factory reset noise
+  FNcol.eeprom_init();
+  attachInterrupt(digitalPinToInterrupt(CC1100_IN_PIN), IsrHandler, CHANGE);
+  OCR1A = 20000; // SILENCE 4 ms= 4 * 5.000
+  timer1_isr_init();
+  timer1_attachInterrupt(IsrTimer1);
+  timer1_enable(TIM_DIV16, TIM_EDGE, TIM_SINGLE);
+  timer1_write(OCR1A);
+  display.channel = DISPLAY_USB;
+  TTYdata.init();
+  FHT.fht_init();
+  RfReceive.tx_init();
+  RfFrame.init();
+  RfRouter.init();
+  Sched.add(PROF_CLOCK, []() { CLOCK.IsrHandler(); Sched.wake(SCHED_EV_TICK); },
+            0, 8000);
+  Sched.add(PROF_ANALYZE, []() {
+              RfReceive.RfAnalyze_Task();
+              if(RfReceive.pending())
+                Sched.wake(SCHED_EV_RF);
+            }, SCHED_EV_RF, 0);
+  Sched.add(PROF_SEND, []() { RfSend.task(); }, SCHED_EV_TX|SCHED_EV_TICK, 0);
+  Sched.add(PROF_MINUTE, []() { CLOCK.Minute_Task(); }, SCHED_EV_TICK, 0);
+  Sched.add(PROF_FHT, []() { FHT.fht_task(); }, SCHED_EV_TX|SCHED_EV_TICK, 0);
+  Sched.add(PROF_ROUTER, []() { RfRouter.task(); }, SCHED_EV_RF|SCHED_EV_TICK, 0);
+  Sched.add(PROF_MQTT, []() { Mqtt.task(); }, 0, 0);
+  Sched.add(PROF_FLUSH, []() { display.flush(); }, 0, 0);
+  display.flush();
+  Serial.out = out;
+}
+
+static void command(const char *cmd)
+{
+  char buf[TTY_BUFSIZE+1];
+  strncpy(buf, cmd, TTY_BUFSIZE);
+  buf[TTY_BUFSIZE] = 0;
+  if(!TTYdata.callfn(buf)) {
+    fprintf(stderr, "unknown command %s\n", cmd);
+    exit(1);
+  }
+}
+
+static uint64_t loop_us = 100, next_loop;
+
+static void run_until(uint64_t t)
+{
+  while(host_now < t) {
+    host_advance(next_loop < t ? next_loop : t);
+    if(host_now >= next_loop) {
+      Sched.run();                      // loop(), as in culfw-esp8266.ino
+      next_loop = host_now + loop_us;
+    }
+  }
+}
+
+// -m: wait up to ms real time for the broker
+static void mqtt_wait(bool (*done)(void), int ms)
+{
+  while(ms-- && !done()) {
+    usleep(1000);
+    run_until(host_now + 1000);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////
+// trace i/o
+typedef struct {
+  uint8_t level;
+  uint32_t us;
+} pulse_t;
+
+static int read_trace(const char *name, std::vector<pulse_t> &tr)
+{
+  FILE *fp = strcmp(name, "-") ? fopen(name, "r") : stdin;
+  if(!fp) {
+    perror(name);
+    return 0;
+  }
+  char line[128], kind[16];
+  unsigned long us;
+  int lineno = 0;
+  while(fgets(line, sizeof(line), fp)) {
+    lineno++;
+    char *p = line + strspn(line, " \t");
+    if(*p == '#' || *p == '\n' || *p == '\r' || *p == 0)
+      continue;
+    if(sscanf(p, "%15s %lu", kind, &us) != 2 ||
+       (strcmp(kind, "pulse") && strcmp(kind, "space"))) {
+      fprintf(stderr, "%s:%d: expected pulse/space <us>\n", name, lineno);
+      return 0;
+    }
+    uint8_t level = kind[0] == 'p';
+    if(!tr.empty() && tr.back().level == level)
+      tr.back().us += us;
+    else
+      tr.push_back({ level, (uint32_t)us });
+  }
+  if(fp != stdin)
+    fclose(fp);
+  return 1;
+}
+
+static uint8_t  rec_level;
+static uint64_t rec_since;
+
+static void record_flush(void)
+{
+  if(rec_since)
+    printf("%s %lu\n", rec_level ? "pulse" : "space",
+           (unsigned long)(host_now - rec_since));
+  rec_since = host_now;
+}
+
+static void record_hook(uint8_t pin, uint8_t val)
+{
+  if(pin != CC1100_OUT_PIN || val == rec_level)
+    return;
+  record_flush();
+  rec_level = val;
+}
+
+// -b: RfAnalyze_Task switches the LED on while it decodes a bucket
+uint16_t host_analyze_repeat;
+static uint64_t bench_ns, bench_start;
+static unsigned long bench_buckets;
+
+static uint64_t now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void bench_hook(uint8_t pin, uint8_t val)
+{
+  if(pin != LED_PIN)
+    return;
+#ifdef LED_INV
+  val = !val;
+#endif
+  if(val) {
+    bench_start = now_ns();
+  } else if(bench_start) {
+    bench_ns += now_ns() - bench_start;
+    bench_buckets++;
+    bench_start = 0;
+  }
+}
+
+static void replay(const std::vector<pulse_t> &tr)
+{
+  uint64_t t = host_now;
+  for(const pulse_t &p : tr) {
+    run_until(t);
+    host_set_pin(CC1100_IN_PIN, p.level);
+    t += p.us;
+  }
+  run_until(t);
+  host_set_pin(CC1100_IN_PIN, 0);
+  run_until(t + 500000);                // let silence and the analyzer run
+}
+
+int main(int argc, char **argv)
+{
+  const char *report = "01", *broker = 0;
+  int gen = 0, opt;
+  unsigned long rounds = 1;
+  std::vector<const char *> pre, post;
+
+  while((opt = getopt(argc, argv, "gb:x:l:r:m:c:C:")) != -1) {
+    switch(opt) {
+    case 'g': gen = 1; break;
+    case 'b': host_analyze_repeat = strtoul(optarg, 0, 0); break;
+    case 'c': pre.push_back(optarg); break;
+    case 'C': post.push_back(optarg); break;
+    case 'x': report = optarg; break;
+    case 'l': loop_us = strtoul(optarg, 0, 0); break;
+    case 'r': rounds = strtoul(optarg, 0, 0); break;
+    case 'm': broker = optarg; break;
+    default:
+      fprintf(stderr, "usage: %s [-x XX] [-l us] [-r n] [-b n] [-m ip:port] [-cC cmd] trace...\n"
+                      "       %s -g cmd...\n", argv[0], argv[0]);
+      return 1;
+    }
+  }
+
+  setup();
+  host_now = 1000000;
+
+  if(gen) {
+    host_write_hook = record_hook;
+    for(int i = optind; i < argc; i++) {
+      printf("# %s\n", argv[i]);
+      RfSend.credit_10ms = MAX_CREDIT;
+      Serial.out = stderr;
+      command(argv[i]);
+      while(RfSend.tx_state == TX_RUN)  // timer1 plays it out
+        host_advance(host_now + 1);
+      RfSend.task();
+      display.flush();
+      Serial.out = stdout;
+      record_flush();                   // the trailing pause
+      rec_since = 0;
+    }
+    return 0;
+  }
+
+  char x[8];
+  snprintf(x, sizeof(x), "X%s", report);
+  command(x);
+  for(const char *c : pre)
+    command(c);
+  if(broker) {
+    char q[32];
+    snprintf(q, sizeof(q), "Qb%s", broker);
+    Serial.out = 0;
+    command(q);
+    Serial.out = stdout;
+    display.channel |= DISPLAY_MQTT;
+    mqtt_wait([]() { return Mqtt.state == MQTT_UP; }, 3000);
+    if(Mqtt.state != MQTT_UP) {
+      fprintf(stderr, "no connection to %s\n", broker);
+      return 1;
+    }
+    mqtt_wait([]() { return false; }, 200);  // SUBACK, a retained command
+  }
+
+  std::vector<pulse_t> tr;
+  for(int i = optind; i < argc; i++)
+    if(!read_trace(argv[i], tr))
+      return 1;
+
+  if(host_analyze_repeat)
+    host_write_hook = bench_hook;
+  clock_t start = clock();
+  uint64_t vstart = host_now;
+  for(unsigned long r = 0; r < rounds; r++)
+    replay(tr);
+
+  if(rounds > 1) {
+    double cpu = (double)(clock() - start) / CLOCKS_PER_SEC;
+    fprintf(stderr, "%lu rounds, %lu edges, %.1fs virtual, %.3fs cpu\n",
+            rounds, (unsigned long)(rounds * tr.size()),
+            (host_now - vstart) / 1e6, cpu);
+  }
+  if(host_analyze_repeat)
+    fprintf(stderr, "%lu buckets, %.1f ns per decode\n", bench_buckets,
+            bench_buckets ? (double)bench_ns / bench_buckets /
+                            (host_analyze_repeat + 1) : 0.0);
+  for(const char *c : post)
+    command(c);
+  display.flush();
+  if(broker)
+    mqtt_wait([]() { return !Mqtt.queued(); }, 3000);
+  return 0;
+}
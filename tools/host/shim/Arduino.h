@@ -0,0 +1,88 @@
+#ifndef Arduino_h
+#define Arduino_h
+
+// Minimal ESP8266 Arduino core for the host build in tools/host. Time is
+// virtual: delays advance the host clock, timer1 counts down against it and
+// the GPIOs are plain variables the harness drives and records.
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+#include "pgmspace.h"
+#include "WString.h"
+#include "HardwareSerial.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+using std::min;
+using std::max;
+
+#define HIGH            1
+#define LOW             0
+#define INPUT           0x00
+#define OUTPUT          0x01
+#define INPUT_PULLUP    0x02
+#define CHANGE          3
+#define FALLING         2
+#define RISING          1
+#define MSBFIRST        1
+#define LSBFIRST        0
+#define BUILTIN_LED     2
+#define LED_BUILTIN     2
+
+#define ICACHE_RAM_ATTR
+#define _BV(bit)        (1 << (bit))
+
+#define cli()
+#define sei()
+#define noInterrupts()
+#define interrupts()
+#define yield()
+
+#define digitalPinToInterrupt(p)  (p)
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int  digitalRead(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*fn)(void), int mode);
+void detachInterrupt(uint8_t pin);
+
+unsigned long micros(void);
+unsigned long millis(void);
+uint64_t micros64(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// timer1, counting down from the written value at 5 ticks per us (TIM_DIV16)
+#define TIM_DIV1        0
+#define TIM_DIV16       1
+#define TIM_DIV256      3
+#define TIM_EDGE        0
+#define TIM_LEVEL       1
+#define TIM_SINGLE      0
+#define TIM_LOOP        1
+
+extern uint32_t host_t1l;
+#define T1L             host_t1l
+
+void timer1_isr_init(void);
+void timer1_attachInterrupt(void (*fn)(void));
+void timer1_detachInterrupt(void);
+void timer1_enable(uint8_t divider, uint8_t int_type, uint8_t reload);
+void timer1_disable(void);
+void timer1_write(uint32_t ticks);
+uint32_t timer1_read(void);
+
+// GPIO pin control / interrupt enable registers
+extern uint32_t host_gpc[16];
+extern uint32_t host_gpie;
+#define GPC(p)          host_gpc[(p) & 0xF]
+#define GPCI            7
+#define GPIE            host_gpie
+
+#endif
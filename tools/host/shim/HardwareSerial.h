@@ -0,0 +1,40 @@
+#ifndef HardwareSerial_h
+#define HardwareSerial_h
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define DEC 10
+#define HEX 16
+
+class __FlashStringHelper;
+
+// Serial writes to a host FILE (stdout by default, NULL discards) and
+// reads from a string the harness queued with host_serial_input().
+class HardwareSerial {
+public:
+  FILE *out;
+  HardwareSerial() : out(stdout) {}
+  void begin(unsigned long) {}
+  int available(void);
+  int read(void);
+  size_t write(uint8_t c);
+  size_t write(const uint8_t *buf, size_t len);
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(const char *s);
+  size_t print(const __FlashStringHelper *s) { return print((const char *)s); }
+  size_t print(long n, int base = DEC);
+  size_t print(unsigned long n, int base = DEC);
+  size_t print(int n, int base = DEC) { return print((long)n, base); }
+  size_t print(unsigned int n, int base = DEC) { return print((unsigned long)n, base); }
+  size_t print(unsigned char n, int base = DEC) { return print((unsigned long)n, base); }
+  template <typename T> size_t println(T v) { size_t r = print(v); return r + println(); }
+  template <typename T> size_t println(T v, int base) { size_t r = print(v, base); return r + println(); }
+  size_t println(void) { return print("\r\n"); }
+  void flush(void) { if(out) fflush(out); }
+};
+
+extern HardwareSerial Serial;
+void host_serial_input(const char *s);
+
+#endif
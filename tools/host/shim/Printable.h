@@ -0,0 +1,3 @@
+#ifndef Printable_h
+#define Printable_h
+#endif
@@ -0,0 +1,36 @@
+#ifndef _SPI_H_INCLUDED
+#define _SPI_H_INCLUDED
+
+#include <stdint.h>
+
+#define SPI_CLOCK_DIV2 0
+
+// Talks to the simulated CC1101 of the host build (shim/host.cpp); the
+// chip select is the SPI_SS pin driven through digitalWrite.
+class SPIClass {
+public:
+  void begin(void) {}
+  void setBitOrder(uint8_t) {}
+  void setClockDivider(uint32_t) {}
+  uint8_t transfer(uint8_t data);
+};
+
+extern SPIClass SPI;
+
+// SPI1 registers (esp8266_peri.h) as cc1100.cpp uses them from the ISRs:
+// setting SPIBUSY in SPI1CMD clocks SPI1W0 through SPI.transfer() at once.
+#define SPIBUSY   (1UL << 18)
+#define SPILMOSI  17
+#define SPILMISO  8
+#define SPIMMOSI  0x1FF
+#define SPIMMISO  0x1FF
+
+struct HostSpiCmd {
+  uint32_t operator&(uint32_t) const { return 0; }
+  void operator|=(uint32_t v);
+};
+
+extern HostSpiCmd SPI1CMD;
+extern uint32_t SPI1W0, SPI1U1;
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef String_class_h
+#define String_class_h
+
+#include <string>
+
+// Just enough of Arduino's String for FNcol.ers/ews
+class String {
+public:
+  String(const char *s = "") : s_(s ? s : "") {}
+  unsigned int length(void) const { return s_.length(); }
+  const char *c_str(void) const { return s_.c_str(); }
+  char operator[](unsigned int i) const { return i < s_.length() ? s_[i] : 0; }
+private:
+  std::string s_;
+};
+
+#endif
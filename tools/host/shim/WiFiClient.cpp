@@ -0,0 +1,101 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+
+#include "WiFiClient.h"
+
+#define HOST_SNDBUF 4096                // what availableForWrite() offers
+
+int WiFiClient::connect(const char *host, uint16_t port)
+{
+  struct sockaddr_in sa = {};
+  sa.sin_family = AF_INET;
+  sa.sin_port = htons(port);
+  if(!inet_aton(host, &sa.sin_addr))
+    return 0;
+
+  stop();
+  fd = socket(AF_INET, SOCK_STREAM, 0);
+  if(fd < 0)
+    return 0;
+  fcntl(fd, F_SETFL, O_NONBLOCK);
+  if(::connect(fd, (struct sockaddr *)&sa, sizeof(sa)) && errno != EINPROGRESS) {
+    stop();
+    return 0;
+  }
+  struct pollfd p = { fd, POLLOUT, 0 };
+  int err = 0;
+  socklen_t len = sizeof(err);
+  if(poll(&p, 1, timeout) != 1 ||
+     getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) || err) {
+    stop();
+    return 0;
+  }
+  return 1;
+}
+
+void WiFiClient::setNoDelay(bool nodelay)
+{
+  int on = nodelay;
+  if(fd >= 0)
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+}
+
+// Closed by the peer: readable, but nothing to read
+uint8_t WiFiClient::connected(void)
+{
+  if(fd < 0)
+    return 0;
+  char c;
+  int n = recv(fd, &c, 1, MSG_PEEK);
+  if(n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+    stop();
+    return 0;
+  }
+  return 1;
+}
+
+int WiFiClient::available(void)
+{
+  int n = 0;
+  if(fd < 0 || ioctl(fd, FIONREAD, &n))
+    return 0;
+  return n;
+}
+
+int WiFiClient::read(uint8_t *buf, size_t len)
+{
+  if(fd < 0)
+    return -1;
+  return recv(fd, buf, len, 0);
+}
+
+size_t WiFiClient::availableForWrite(void)
+{
+  int queued = 0;
+  if(fd < 0)
+    return 0;
+  ioctl(fd, TIOCOUTQ, &queued);
+  return queued < HOST_SNDBUF ? HOST_SNDBUF - queued : 0;
+}
+
+size_t WiFiClient::write(const uint8_t *buf, size_t len)
+{
+  if(fd < 0)
+    return 0;
+  ssize_t n = send(fd, buf, len, MSG_NOSIGNAL);
+  return n > 0 ? n : 0;
+}
+
+void WiFiClient::stop(void)
+{
+  if(fd >= 0)
+    close(fd);
+  fd = -1;
+}
@@ -0,0 +1,30 @@
+#ifndef WiFiClient_h
+#define WiFiClient_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+// WiFiClient on a host TCP socket, the part libraries/mqtt uses. connect()
+// blocks up to the timeout, afterwards the socket is non-blocking as the
+// lwIP one is: write() takes what fits, read() returns what is there.
+class WiFiClient {
+public:
+  WiFiClient() : fd(-1), timeout(1000) {}
+  ~WiFiClient() { stop(); }
+  void setTimeout(unsigned long ms) { timeout = ms; }
+  void setNoDelay(bool nodelay);
+  int connect(const char *host, uint16_t port);
+  uint8_t connected(void);
+  int available(void);
+  int read(uint8_t *buf, size_t len);
+  size_t availableForWrite(void);
+  size_t write(const uint8_t *buf, size_t len);
+  void stop(void);
+
+private:
+  int fd;
+  unsigned long timeout;
+  WiFiClient(const WiFiClient &);
+};
+
+#endif
@@ -0,0 +1,221 @@
+#include <Arduino.h>
+#include <SPI.h>
+#include <EEPROM.h>
+#include "board.h"
+#include "host.h"
+
+HardwareSerial Serial;
+SPIClass SPI;
+HostSpiCmd SPI1CMD;
+uint32_t SPI1W0, SPI1U1;
+
+// SPI1CMD |= SPIBUSY
+void HostSpiCmd::operator|=(uint32_t v)
+{
+  if(v & SPIBUSY)
+    SPI1W0 = SPI.transfer((uint8_t)SPI1W0);
+}
+
+EEPROMClass EEPROM;
+
+uint64_t host_now;
+void (*host_write_hook)(uint8_t pin, uint8_t val);
+
+static uint8_t pins[17];
+static void (*pin_isr[17])(void);
+uint32_t host_gpc[16];
+uint32_t host_gpie;
+
+//////////////////////////////////////////////////////////////////////
+// timer1: armed by timer1_write, single shot, 5 ticks per us
+uint32_t host_t1l;
+static uint64_t t1_start;
+static uint8_t  t1_armed;
+static void (*t1_isr)(void);
+
+void timer1_isr_init(void) {}
+void timer1_attachInterrupt(void (*fn)(void)) { t1_isr = fn; }
+void timer1_detachInterrupt(void) { t1_isr = 0; }
+void timer1_enable(uint8_t divider, uint8_t int_type, uint8_t reload)
+{
+  (void)divider; (void)int_type; (void)reload;
+}
+void timer1_disable(void) { t1_armed = 0; }
+
+void timer1_write(uint32_t ticks)
+{
+  host_t1l = ticks;
+  t1_start = host_now;
+  t1_armed = 1;
+}
+
+uint32_t timer1_read(void)
+{
+  uint64_t el = (host_now - t1_start) * 5;
+  return el >= host_t1l ? 0 : host_t1l - (uint32_t)el;
+}
+
+void host_advance(uint64_t until)
+{
+  while(t1_armed) {
+    uint64_t fire = t1_start + (host_t1l+4)/5;
+    if(fire > until)
+      break;
+    host_now = fire;
+    t1_armed = 0;
+    if(t1_isr)
+      t1_isr();
+  }
+  if(until > host_now)
+    host_now = until;
+}
+
+unsigned long micros(void) { return (unsigned long)host_now; }
+unsigned long millis(void) { return (unsigned long)(host_now/1000); }
+uint64_t micros64(void) { return host_now; }
+void delayMicroseconds(unsigned int us) { host_advance(host_now + us); }
+void delay(unsigned long ms) { host_advance(host_now + ms*1000); }
+
+//////////////////////////////////////////////////////////////////////
+// GPIO
+static void cc_select(uint8_t val);
+
+void pinMode(uint8_t pin, uint8_t mode) { (void)pin; (void)mode; }
+
+int digitalRead(uint8_t pin) { return pin < 17 ? pins[pin] : 0; }
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+  if(pin >= 17)
+    return;
+  val = val ? 1 : 0;
+  if(pin == SPI_SS)
+    cc_select(val);
+  pins[pin] = val;
+  if(host_write_hook)
+    host_write_hook(pin, val);
+}
+
+void attachInterrupt(uint8_t pin, void (*fn)(void), int mode)
+{
+  pin_isr[pin & 0xF] = fn;
+  GPC(pin) = (GPC(pin) & ~(0xF << GPCI)) | ((mode & 0xF) << GPCI);
+}
+
+void detachInterrupt(uint8_t pin)
+{
+  pin_isr[pin & 0xF] = 0;
+  GPC(pin) &= ~(0xF << GPCI);
+}
+
+void host_set_pin(uint8_t pin, uint8_t val)
+{
+  val = val ? 1 : 0;
+  if(pins[pin] == val)
+    return;
+  pins[pin] = val;
+  if(pin_isr[pin & 0xF] && (GPC(pin) >> GPCI) & 0xF)
+    pin_isr[pin & 0xF]();
+}
+
+//////////////////////////////////////////////////////////////////////
+// Serial
+static const char *ser_in;
+
+void host_serial_input(const char *s) { ser_in = s; }
+int HardwareSerial::available(void) { return ser_in && *ser_in ? 1 : 0; }
+int HardwareSerial::read(void) { return available() ? *ser_in++ : -1; }
+
+size_t HardwareSerial::write(uint8_t c)
+{
+  if(out)
+    fputc(c, out);
+  return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buf, size_t len)
+{
+  if(out)
+    fwrite(buf, 1, len, out);
+  return len;
+}
+
+size_t HardwareSerial::print(const char *s)
+{
+  return write((const uint8_t *)s, strlen(s));
+}
+
+size_t HardwareSerial::print(long n, int base)
+{
+  if(n < 0 && base == DEC)
+    return print('-') + print((unsigned long)-n, base);
+  return print((unsigned long)n, base);
+}
+
+size_t HardwareSerial::print(unsigned long n, int base)
+{
+  char buf[24];
+  snprintf(buf, sizeof(buf), base == HEX ? "%lX" : "%lu", n);
+  return print(buf);
+}
+
+//////////////////////////////////////////////////////////////////////
+// CC1101: register file, PA table and the RX/TX/IDLE state machine,
+// enough for ccInitChip, ccTX/ccRX and readStatus.
+static uint8_t cc_reg[0x30];
+static uint8_t cc_pa[8];
+static uint8_t cc_state;                        // status byte state bits
+static uint8_t cc_hdr;
+static int     cc_cnt = -1;                     // -1: not selected
+
+static void cc_select(uint8_t val)
+{
+  cc_cnt = val ? -1 : 0;
+}
+
+static uint8_t cc_status(uint8_t addr)
+{
+  switch(addr) {
+  case 0x30: return 0x00;                       // PARTNUM
+  case 0x31: return 0x14;                       // VERSION
+  case 0x34: return 0x40;                       // RSSI
+  case 0x35: return cc_state == 0x10 ? 0x0D :   // MARCSTATE
+                    cc_state == 0x20 ? 0x13 : 0x01;
+  }
+  return 0;
+}
+
+uint8_t SPIClass::transfer(uint8_t data)
+{
+  uint8_t ret = cc_state;
+  if(cc_cnt < 0)
+    return 0xff;
+
+  if(cc_cnt++ == 0) {                           // header byte
+    cc_hdr = data;
+    uint8_t addr = data & 0x3f;
+    if(addr >= 0x30 && addr <= 0x3D && !(data & 0x40)) {
+      switch(addr) {                            // strobe
+      case 0x30: memset(cc_reg, 0, sizeof(cc_reg)); cc_state = 0; break;
+      case 0x34: cc_state = 0x10; break;        // SRX
+      case 0x35: cc_state = 0x20; break;        // STX
+      case 0x36: case 0x33: case 0x39: cc_state = 0; break;
+      }
+    }
+    return ret;
+  }
+
+  uint8_t addr = cc_hdr & 0x3f;
+  uint8_t off  = (cc_hdr & 0x40) ? cc_cnt-2 : 0;
+  uint8_t rd   = cc_hdr & 0x80;
+  if(addr == 0x3E)                              // PATABLE
+    return rd ? cc_pa[off & 7] : (cc_pa[off & 7] = data);
+  if(addr == 0x3F)                              // FIFO
+    return 0;
+  if(addr >= 0x30)
+    return (cc_hdr & 0x40) && rd ? cc_status(addr) : ret;
+  addr += off;
+  if(addr >= 0x30)
+    return 0;
+  return rd ? cc_reg[addr] : (cc_reg[addr] = data);
+}
@@ -0,0 +1,15 @@
+#ifndef _HOST_H
+#define _HOST_H
+
+// Harness side of the host shim: virtual clock, GPIO drive and a hook
+// that sees every digitalWrite (used to record what RfSend transmits).
+
+#include <stdint.h>
+
+extern uint64_t host_now;                       // virtual time in us
+
+void host_advance(uint64_t until);              // run timer1 up to until
+void host_set_pin(uint8_t pin, uint8_t val);    // drive an input, fires its ISR
+extern void (*host_write_hook)(uint8_t pin, uint8_t val);
+
+#endif
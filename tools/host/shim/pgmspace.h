@@ -0,0 +1,21 @@
+#ifndef __PGMSPACE_H_
+#define __PGMSPACE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P                 const char *
+#define PSTR(s)               (s)
+#define F(s)                  ((const __FlashStringHelper *)(s))
+#define pgm_read_byte(addr)   (*(const uint8_t *)(addr))
+#define pgm_read_word(addr)   (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr)  (*(const uint32_t *)(addr))
+#define strcpy_P              strcpy
+#define strlen_P              strlen
+#define strcmp_P              strcmp
+#define memcpy_P              memcpy
+
+class __FlashStringHelper;
+
+#endif